@@ -0,0 +1,115 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the Arena class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sys/mman.h>
+#include "arena.hpp"
+
+#define CACHE_LINE 64                    // Alignment of each array
+#define HUGE_PAGE (2*1024*1024)          // Alignment of block backed by huge pages
+
+/********************************************************************************
+ * Constructor initializes an empty arena.
+********************************************************************************/
+Arena::Arena(){
+  base = mapping = NULL;        // Initialize block to empty
+  capacity = used = mapped = 0; // Initialize sizes to 0
+}
+
+/********************************************************************************
+ * Deconstructor unmaps the block.
+********************************************************************************/
+Arena::~Arena(){
+  release();
+}
+
+/********************************************************************************
+ * reserve() maps a block of at least the given size. The pages are not
+ * touched here. With huge pages, the block is aligned to a huge page and
+ * the kernel is asked to back it with transparent huge pages. A block that
+ * is already mapped and large enough is reused as it is, so an object
+ * solving many problems in turn maps only for its largest one.
+********************************************************************************/
+bool Arena::reserve(size_t bytes, bool hugePages){
+  if(mapping && base + bytes <= mapping + mapped){     // If mapped block is large enough
+    capacity = mapped - (base - mapping);                // Reuse whole block
+    used = 0;                                            // Nothing is carved yet
+    return true;                                         // End function by returning true
+  }
+  release();                                           // Unmap any previous block
+  size_t padding = hugePages ? HUGE_PAGE : 0;          // Room to align block
+  mapped = (bytes ? bytes : 1) + padding;              // Size of mapping
+  void *block = mmap(NULL, mapped, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(block == MAP_FAILED){                             // If block could not be mapped
+    std::cerr << "ERROR: OUT OF MEMORY" << std::endl;    // Print error message
+    mapping = base = NULL;
+    mapped = 0;
+    return false;                                        // End function by returning false
+  }
+
+  mapping = static_cast<char*>(block);                 // Record start of mapping
+  base = mapping;                                      // Start block at start of mapping
+  if(hugePages){                                       // If huge pages are requested
+    size_t offset = (size_t)base % HUGE_PAGE;            // Distance past last huge page boundary
+    if(offset){
+      base += HUGE_PAGE - offset;                          // Move to next huge page boundary
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(base, bytes, MADV_HUGEPAGE);                 // Ask for transparent huge pages
+#endif
+  }
+  capacity = bytes;                                    // Record size of block
+  used = 0;                                            // Nothing is carved yet
+  return true;                                         // End function by returning true
+}
+
+/********************************************************************************
+ * allocate() carves the given count of bytes from the block, starting at the
+ * next cache line. Blocks are sized up front for every array carved from
+ * them, so a block too small is a sizing bug, and the program aborts rather
+ * than hand back NULL.
+********************************************************************************/
+void *Arena::allocate(size_t bytes){
+  size_t first = align(used);                          // Next cache line
+  if(first + bytes > capacity){                        // If block is too small
+    std::cerr << "ERROR: ARENA EXHAUSTED, " << bytes << " BYTES ASKED WITH "
+              << capacity - std::min(first, capacity) << " LEFT" << std::endl;   // Print error message
+    std::abort();                                        // Stop before NULL is written through
+  }
+  used = first + bytes;                                // Carve bytes
+  return base + first;                                 // Return start of bytes
+}
+
+/********************************************************************************
+ * reset() lets the block be carved again from its start.
+********************************************************************************/
+void Arena::reset(){
+  used = 0;
+}
+
+/********************************************************************************
+ * release() unmaps the block, freeing every array carved from it at once.
+********************************************************************************/
+void Arena::release(){
+  if(mapping){                                         // If a block is mapped
+    munmap(mapping, mapped);                             // Unmap it
+  }
+  base = mapping = NULL;                               // Block is empty
+  capacity = used = mapped = 0;
+}
+
+/********************************************************************************
+ * align() rounds a count of bytes up to a whole cache line, so callers can
+ * size a block for the arrays they will carve from it.
+********************************************************************************/
+size_t Arena::align(size_t bytes){
+  return (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
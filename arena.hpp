@@ -0,0 +1,43 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The Arena class holds all of a solver's arrays in one block
+ *              of memory that is mapped once, sized up front, and unmapped
+ *              once. Arrays are carved from the block in order, each aligned
+ *              to a cache line. The block can be backed by transparent huge
+ *              pages to cut TLB misses on the n x n matrices. The block's
+ *              size is committed when it is mapped, but pages are only
+ *              placed in memory when first written, so the thread that
+ *              initializes an array decides where it lives.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+
+class Arena{
+  public:
+	char *base;              // Start of block
+	size_t capacity;         // Size of block in bytes
+	size_t used;             // Bytes carved from block
+	size_t mapped;           // Bytes mapped, including alignment padding
+	char *mapping;           // Start of mapping
+
+  public:
+	Arena();                                   // Constructor
+	~Arena();                                  // Deconstructor
+	Arena(const Arena&) = delete;              // Not copied, the block would be unmapped twice
+	Arena &operator=(const Arena&) = delete;
+
+	bool reserve(size_t, bool);                // Map block of given size, optionally with huge pages
+	void *allocate(size_t);                    // Carve bytes from block
+	void reset();                              // Reuse block from its start
+	void release();                            // Unmap block
+	static size_t align(size_t);               // Round bytes up to a whole cache line
+
+	template <class T> T *allocate(size_t count){   // Carve array of count elements from block
+	  return static_cast<T*>(allocate(count*sizeof(T)));
+	}
+};
+#endif
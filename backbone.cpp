@@ -0,0 +1,312 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the BKB class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+ *   Schneider, Froschhammer, Morgenstern, Husslein, Singer, "Searching for
+ *   backbones - an efficient parallel algorithm for the traveling salesman
+ *   problem", Computer Physics Communications 96, 1996
+********************************************************************************/
+#include <algorithm>
+#include <thread>
+#include "ils.hpp"
+#include "backbone.hpp"
+
+#define SAMPLE_SHARE 0.3           // Share of time limit given to short runs
+#define MIN_REDUCED_SIZE 8         // Fewest nodes worth searching as a contracted problem
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+BKB::BKB(){
+  setMaxTime(179);              // Maximum time - specify 180 seconds or INT_MAX
+  setRuns(4);                   // Initialize to 4 short runs
+  share = SAMPLE_SHARE;         // Initialize share of time given to short runs
+  hugePages = false;            // Initialize to regular pages
+  renumber = false;             // Initialize to file order
+  profile = NULL;               // Initialize to size table parameters
+  bestCost = 0;                 // Initialize best tour cost to 0
+  fixedEdges = 0;               // Initialize to no fixed edges
+  reduced = NULL;               // Initialize to no contracted problem
+}
+
+/********************************************************************************
+ * Deconstructor deletes the GLS objects, sharing ones before the owner.
+********************************************************************************/
+BKB::~BKB(){
+  delete reduced;                                     // Delete contracted problem's object
+  for(int i = samplers.size() - 1; i >= 0; i--){      // For each GLS object, owner last
+    delete samplers[i];                                 // Delete GLS object
+  }
+}
+
+/********************************************************************************
+ * setMaxTime() initializes the algorithm time limit.
+********************************************************************************/
+void BKB::setMaxTime(double limit){
+  maxTime = limit;
+}
+
+/********************************************************************************
+ * setRuns() initializes the count of short GLS runs. At least two are needed
+ * to find edges they agree on.
+********************************************************************************/
+void BKB::setRuns(int count){
+  runs = max(count, 2);
+}
+
+/********************************************************************************
+ * setHugePages() sets whether each GLS object's arena is backed by
+ * transparent huge pages.
+********************************************************************************/
+void BKB::setHugePages(bool enable){
+  hugePages = enable;
+}
+
+/********************************************************************************
+ * setRenumber() sets whether the cities are renumbered along a Hilbert curve
+ * when read.
+********************************************************************************/
+void BKB::setRenumber(bool enable){
+  renumber = enable;
+}
+
+/********************************************************************************
+ * setProfile() sets the profile that picks the GLS parameters of the short
+ * runs and of the contracted problem's search.
+********************************************************************************/
+void BKB::setProfile(TUN *tuner){
+  profile = tuner;
+}
+
+/********************************************************************************
+ * setProblem() reads in cities into the first GLS object, then creates the
+ * other short run objects sharing its coordinates and distances, and
+ * initializes each on its own thread. Large problems start from the same
+ * Hilbert curve tour and take the same Christofides tour, and GLS would
+ * follow the same path from them in every run, so every run but the first
+ * is ILS, whose random kicks set it apart.
+********************************************************************************/
+bool BKB::setProblem(string input){
+  samplers.push_back(new GLS);                         // Create GLS object owning the distances
+  samplers[0]->setHugePages(hugePages);
+  samplers[0]->setRenumber(renumber);
+  if(!samplers[0]->TSP::setProblem(input)){            // If cities cannot be read
+    return false;                                        // End function by returning false
+  }
+  for(int i = 1; i < runs; i++){                       // For each other GLS object
+    samplers.push_back(samplers[0]->size > CHRISTOFIDES_SIZE ? new ILS : new GLS);   // Create search object
+    samplers[i]->setHugePages(hugePages);
+    samplers[i]->TSP::setProblem(*samplers[0]);          // Share cities and distances
+  }
+
+  vector<std::thread> pool;                            // Worker threads
+  for(int i = 0; i < runs; i++){                       // For each GLS object
+    pool.push_back(std::thread([this, i](){
+      samplers[i]->initialize();                         // Initialize dynamic arrays
+      samplers[i]->setGlsIterations(INT_MAX);            // Search until time limit
+      if(profile){                                       // If a profile is set
+        samplers[i]->setMaxTime(share*maxTime);            // Describe problem at short runs' time limit
+        profile->setParameters(*samplers[i]);              // Apply its parameters
+      }
+    }));
+  }
+  for(int i = 0; i < runs; i++){                       // For each thread
+    pool[i].join();                                      // Wait for initialization to finish
+  }
+  return true;                                         // End function by returning true
+}
+
+/********************************************************************************
+ * runAlgorithm() runs the short runs, contracts the backbone of their best
+ * tours and searches the contracted problem for the rest of the time limit,
+ * then writes the best tour found. If the backbone leaves too few nodes to
+ * search, the best short run continues on the whole problem instead.
+********************************************************************************/
+void BKB::runAlgorithm(){
+  runSamples();                                        // Run short runs
+  if(contract()){                                      // If backbone was contracted
+    reduced->setMaxTime(maxTime - samplers[0]->getDuration());   // Search for rest of time limit
+    if(profile){                                         // If a profile is set
+      profile->setParameters(*reduced);                    // Apply its parameters
+    }
+    reduced->search();                                   // Search contracted problem
+    expand(reduced->best);                               // Expand its best tour
+  }
+  else{                                                // Else, nothing left to contract
+    GLS *solver = samplers[0];
+    for(int i = 1; i < runs; i++){                       // For each run
+      if(samplers[i]->bestCost < solver->bestCost){        // If it found a better tour
+        solver = samplers[i];
+      }
+    }
+    solver->setMaxTime(maxTime);                         // Continue best run to time limit
+    solver->search();
+    best.assign(solver->best, solver->best + solver->size);
+    bestCost = solver->bestCost;
+  }
+  outputResults();                                     // Call function to print algorithm results
+}
+
+/********************************************************************************
+ * runSamples() runs every short run on its own thread for its share of the
+ * time limit.
+********************************************************************************/
+void BKB::runSamples(){
+  vector<std::thread> pool;                            // Worker threads
+  for(int i = 0; i < runs; i++){                       // For each GLS object
+    samplers[i]->setMaxTime(share*maxTime);              // Set end of short runs as its time limit
+    pool.push_back(std::thread([this, i](){ samplers[i]->search(); }));
+  }
+  for(int i = 0; i < runs; i++){                       // For each thread
+    pool[i].join();                                      // Wait for run to finish
+  }
+}
+
+/********************************************************************************
+ * contract() fixes the edges found in every short run's best tour, and builds
+ * the contracted problem. Walking the best run's tour, which holds every
+ * fixed edge, each city with fewer than two fixed edges becomes a node, and
+ * the cities between two nodes are the inner cities of a fixed path from the
+ * first node to the second. The two ends of a path are joined by a fixed
+ * edge of distance 0, so the contracted tour's cost plus the fixed distance
+ * is the expanded tour's cost. The contracted problem starts from the best
+ * run's tour. Returns false if it would have too few nodes to search.
+********************************************************************************/
+bool BKB::contract(){
+  GLS *owner = samplers[0];                            // Object owning the distances
+  int size = owner->size;
+  int first = 0;                                       // Run with the best tour
+  for(int i = 1; i < runs; i++){
+    if(samplers[i]->bestCost < samplers[first]->bestCost){
+      first = i;
+    }
+  }
+  const int *tour = samplers[first]->best;             // Best run's tour
+
+  vector<int> next(size), prev(size);                  // Each run's neighbors of each city
+  vector<char> fixed(size, 1);                         // Edge after each city is in every tour
+  for(int r = 0; r < runs; r++){                       // For each run
+    const int *other = samplers[r]->best;
+    for(int i = 0; i < size; i++){                       // For each city of its tour
+      next[other[i]] = other[(i + 1) % size];              // Record its neighbors
+      prev[other[i]] = other[(i + size - 1) % size];
+    }
+    for(int i = 0; i < size; i++){                       // For each edge of the best tour
+      int c1 = tour[i], c2 = tour[(i + 1) % size];
+      fixed[c1] = fixed[c1] && (next[c1] == c2 || prev[c1] == c2);   // Keep it if this tour has it
+    }
+  }
+
+  fixedEdges = std::count(fixed.begin(), fixed.end(), 1);   // Count fixed edges
+  if(fixedEdges == size){                              // If every run found the same tour
+    fixed[tour[size - 1]] = 0;                           // Free one edge so the tour stays open
+    fixedEdges--;
+  }
+
+  int start = 0;                                       // Place of first node in best tour
+  while(fixed[tour[start]] && fixed[tour[(start + size - 1) % size]]){   // While city is inside a path
+    start++;
+  }
+  cities.clear();
+  inner.clear();
+  offset.clear();
+  for(int k = 0; k < size; k++){                       // For each place from first node
+    int i = (start + k) % size;
+    int city = tour[i];
+    if(fixed[city] && fixed[tour[(i + size - 1) % size]]){   // If city is inside a path
+      inner.push_back(city);                               // Record it as inner city
+    }
+    else{                                                // Else, city is a node
+      cities.push_back(city);
+      offset.push_back(inner.size());
+    }
+  }
+  int count = cities.size();                           // Count of nodes
+  if(count < MIN_REDUCED_SIZE){                        // If too few nodes are left
+    return false;
+  }
+  offset.push_back(inner.size());
+  partner.assign(count, -1);
+  for(int u = 0; u < count; u++){                      // For each node
+    if(fixed[cities[u]]){                                // If a path leaves it toward the next node
+      partner[u] = (u + 1) % count;                        // Join them by a fixed edge
+      partner[(u + 1) % count] = u;
+    }
+  }
+
+  vector<int> xs(count), ys(count);
+  for(int u = 0; u < count; u++){                      // For each node
+    xs[u] = owner->x[cities[u]];                         // Copy city's coordinates
+    ys[u] = owner->y[cities[u]];
+  }
+  reduced = new GLS;                                   // Create contracted problem's object
+  reduced->setHugePages(hugePages);
+  if(!reduced->setProblem(xs.data(), ys.data(), count)){   // If arrays do not fit in memory
+    return false;
+  }
+  for(int u = 0; u < count; u++){                      // For each path
+    if(partner[u] >= 0){
+      reduced->distance[u][partner[u]] = 0;                // Its fixed distance is added back later
+    }
+  }
+  for(int u = 0; u < count; u++){                      // For each node
+    reduced->tour[u] = u;                                // Start from best run's order
+  }
+  reduced->tourCost = reduced->getTourCost(reduced->tour);   // Get the cost of the tour
+  reduced->setBest();                                  // Set the best tour as current tour
+  reduced->setPartners(partner.data());                // Fix paths' ends together
+  reduced->initializeSearch();                         // Create GLS arrays for the tour
+  reduced->setGlsIterations(INT_MAX);                  // Search until time limit
+  return true;
+}
+
+/********************************************************************************
+ * expand() puts each fixed path's inner cities between its two ends in a
+ * contracted tour, in the direction the tour crosses the path, and records
+ * the result as the best tour.
+********************************************************************************/
+void BKB::expand(const int *nodes){
+  int count = cities.size();
+  best.clear();
+  for(int k = 0; k < count; k++){                      // For each node of tour
+    int u = nodes[k], v = nodes[(k + 1) % count];
+    best.push_back(cities[u]);                           // Add its city
+    if(partner[u] != v){                                 // If tour does not cross a path here
+      continue;
+    }
+    if(v == (u + 1) % count){                            // If tour crosses path forward
+      for(int i = offset[u]; i < offset[u + 1]; i++){
+        best.push_back(inner[i]);
+      }
+    }
+    else{                                                // Else, tour crosses path backward
+      for(int i = offset[v + 1] - 1; i >= offset[v]; i--){
+        best.push_back(inner[i]);
+      }
+    }
+  }
+  bestCost = samplers[0]->getTourCost(best.data());    // Get cost of expanded tour
+}
+
+/********************************************************************************
+ * outputResults() hands the best tour to the owning object, which writes it
+ * to the output file and prints the final limits, then prints the size of
+ * the backbone.
+********************************************************************************/
+void BKB::outputResults(){
+  GLS *owner = samplers[0];                            // Object owning the output
+  int iterations = reduced ? reduced->iteration : 0;   // Iterations of all objects
+  for(int i = 0; i < runs; i++){
+    iterations += samplers[i]->iteration;
+  }
+  std::copy(best.begin(), best.end(), owner->best);    // Copy best tour
+  owner->bestCost = bestCost;
+  owner->iteration = iterations;
+  owner->time = owner->getDuration();
+  owner->outputResults();
+  cout << "Backbone: " << fixedEdges << " of " << owner->size << " edges fixed, "
+       << cities.size() << " nodes searched" << endl;
+}
@@ -0,0 +1,58 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The BKB class shrinks a problem by its backbone. A few short
+ *              GLS runs sharing one distance matrix are run first, and the
+ *              edges found in every run's best tour are fixed. Each path of
+ *              fixed edges is contracted to its two end cities, joined by a
+ *              fixed edge that moves may not remove, and one long GLS run
+ *              searches the smaller problem. Its best tour is expanded back
+ *              by putting each path's inner cities between its ends.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef BACKBONE_HPP
+#define BACKBONE_HPP
+
+#include <vector>
+#include "gls.hpp"
+#include "tuning.hpp"
+
+using std::vector;
+
+class BKB{
+  public:
+	double maxTime;          // Time limit
+	double share;            // Share of time limit given to short runs
+	int runs;                // Count of short GLS runs
+	bool hugePages;          // Back GLS arenas with transparent huge pages
+	bool renumber;           // Renumber cities along a Hilbert curve
+	TUN *profile;            // Parameters of GLS objects, or NULL for size tables
+	int bestCost;            // Best tour distance
+	int fixedEdges;          // Count of fixed edges
+
+	vector<GLS*> samplers;   // Short run search objects, the first owns the distances
+	GLS *reduced;            // GLS object searching the contracted problem
+	vector<int> best;        // Best tour
+	vector<int> cities;      // City of each contracted node
+	vector<int> partner;     // Node at the other end of each node's path, or -1
+	vector<int> inner;       // Inner cities of each path, in the order of the best short run
+	vector<int> offset;      // Start of inner cities following each node
+
+  public:
+	BKB();                                     // Constructor
+	~BKB();                                    // Deconstructor
+
+	void setMaxTime(double);                   // Set max time for running algorithm
+	void setRuns(int);                         // Set count of short GLS runs
+	void setHugePages(bool);                   // Set whether GLS arenas use huge pages
+	void setRenumber(bool);                    // Set whether cities are renumbered
+	void setProfile(TUN*);                     // Set profile picking parameters of GLS objects
+
+	bool setProblem(string);                   // Initialize record of cities
+	void runAlgorithm();                       // Run the algorithm
+	void runSamples();                         // Run short GLS runs in parallel
+	bool contract();                           // Build contracted problem from backbone
+	void expand(const int*);                   // Expand a contracted tour into the best tour
+	void outputResults();                      // Write best tour to output file
+};
+#endif
@@ -0,0 +1,242 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This file builds the tsp Python module, which runs the solver
+ *              inside the calling Python process instead of starting ./tsp
+ *              and reading and writing files:
+ *
+ *                import tsp
+ *                tour, cost = tsp.solve(coords, seconds=1.0, seed=None, engine="gls")
+ *
+ *              coords is any object with the buffer protocol of shape (n, 2),
+ *              such as a NumPy array. Rows of 32-bit integers are read in
+ *              place, without a copy; other integer and float types are
+ *              rounded into a temporary array first. The solver runs with the
+ *              GIL released, so Python threads can solve many instances at
+ *              once, each with its own solver object. The tour is returned as
+ *              a NumPy array of 32-bit city IDs when NumPy is installed, and
+ *              as an array.array otherwise.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <new>
+#include <random>
+#include "exact.hpp"
+#include "gls.hpp"
+#include "ils.hpp"
+#include "planner.hpp"
+#include "tempering.hpp"
+
+static PyObject *arrayType = NULL;     // array.array, made into the returned tour
+static PyObject *frombuffer = NULL;    // numpy.frombuffer, or None without NumPy
+
+/********************************************************************************
+ * getValue() returns the coordinate at one buffer item as an integer,
+ * rounding floats, or sets a Python error and returns false if the item's
+ * type is not a number.
+********************************************************************************/
+static bool getValue(const char *item, char code, int &value){
+  switch(code){
+    case 'b': value = *(const signed char*)item; return true;
+    case 'B': value = *(const unsigned char*)item; return true;
+    case 'h': value = *(const short*)item; return true;
+    case 'H': value = *(const unsigned short*)item; return true;
+    case 'i': value = *(const int*)item; return true;
+    case 'I': value = *(const unsigned int*)item; return true;
+    case 'l': value = *(const long*)item; return true;
+    case 'L': value = *(const unsigned long*)item; return true;
+    case 'q': value = *(const long long*)item; return true;
+    case 'Q': value = *(const unsigned long long*)item; return true;
+    case 'f': value = lround(*(const float*)item); return true;
+    case 'd': value = lround(*(const double*)item); return true;
+  }
+  PyErr_Format(PyExc_TypeError, "coordinates of type '%c' are not supported", code);
+  return false;
+}
+
+/********************************************************************************
+ * getTour() wraps the best tour in the returned object: a NumPy array viewing
+ * an array.array's memory, or the array.array itself without NumPy. The
+ * modules are looked up on the first call.
+********************************************************************************/
+static PyObject *getTour(const vector<int> &best){
+  if(!arrayType){                                       // If modules were not looked up yet
+    PyObject *module = PyImport_ImportModule("array");
+    if(!module){
+      return NULL;
+    }
+    arrayType = PyObject_GetAttrString(module, "array");
+    Py_DECREF(module);
+    if(!arrayType){
+      return NULL;
+    }
+    module = PyImport_ImportModule("numpy");
+    if(module){                                           // If NumPy is installed
+      frombuffer = PyObject_GetAttrString(module, "frombuffer");
+      Py_DECREF(module);
+    }
+    if(!frombuffer){                                      // Else, return array.array
+      PyErr_Clear();
+      Py_INCREF(Py_None);
+      frombuffer = Py_None;
+    }
+  }
+
+  PyObject *bytes = PyBytes_FromStringAndSize((const char*)best.data(), best.size()*sizeof(int));
+  if(!bytes){
+    return NULL;
+  }
+  PyObject *tour = PyObject_CallFunction(arrayType, "sO", "i", bytes);   // Tour of 32-bit IDs
+  Py_DECREF(bytes);
+  if(!tour || frombuffer == Py_None){                   // If it failed, or NumPy is missing
+    return tour;
+  }
+  PyObject *view = PyObject_CallFunction(frombuffer, "Os", tour, "int32");   // Array sharing its memory
+  Py_DECREF(tour);
+  return view;
+}
+
+/********************************************************************************
+ * solve() reads the coordinates buffer, runs the chosen engine on it with
+ * the GIL released, and returns the best tour and its cost. Problems of at
+ * most EXACT_SIZE cities are solved exactly, as jobs of the server are.
+********************************************************************************/
+static PyObject *solve(PyObject *self, PyObject *args, PyObject *keywords){
+  static const char *names[] = {"coords", "seconds", "seed", "engine", NULL};
+  PyObject *coords;                                     // Object holding coordinates
+  double seconds = 1.0;                                 // Time limit
+  PyObject *seedValue = Py_None;                        // Seed, or None for a random one
+  const char *engineName = "gls";                       // Search engine
+  if(!PyArg_ParseTupleAndKeywords(args, keywords, "O|dOs", (char**)names,
+                                  &coords, &seconds, &seedValue, &engineName)){
+    return NULL;
+  }
+  string engine = engineName;
+  if(engine != "gls" && engine != "ils" && engine != "tempering"){   // If engine is unknown
+    PyErr_SetString(PyExc_ValueError, "engine must be 'gls', 'ils' or 'tempering'");
+    return NULL;
+  }
+  unsigned seed = std::random_device()();               // Seed of solver's random numbers, new in each process
+  if(seedValue != Py_None){                             // If a seed was given
+    seed = PyLong_AsUnsignedLongMask(seedValue);
+    if(PyErr_Occurred()){
+      return NULL;
+    }
+  }
+
+  Py_buffer view;                                       // Coordinates, held until solved
+  if(PyObject_GetBuffer(coords, &view, PyBUF_STRIDES | PyBUF_FORMAT) < 0){
+    return NULL;
+  }
+  if(view.ndim != 2 || view.shape[1] != 2 || view.shape[0] < 1 || view.shape[0] > INT_MAX){
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "coords must have shape (n, 2) with n at least 1");
+    return NULL;
+  }
+  int count = view.shape[0];                            // Count of cities
+  const char *format = view.format ? view.format : "B"; // Item type, skipping byte order
+  while(*format == '@' || *format == '=' || *format == '<'){
+    format++;
+  }
+
+  const int *xs, *ys;                                   // Cities' x and y values
+  int stride;                                           // Ints from one city to the next
+  vector<int> copy;                                     // Rounded coordinates, if not read in place
+  const char *data = (const char*)view.buf;
+  if((*format == 'i' || *format == 'l') && view.itemsize == sizeof(int) &&
+     view.strides[0] % sizeof(int) == 0 && view.strides[1] % sizeof(int) == 0){   // If rows are 32-bit integers
+    xs = (const int*)data;                                // Read them in place
+    ys = (const int*)(data + view.strides[1]);
+    stride = view.strides[0]/(int)sizeof(int);
+  }
+  else{                                                 // Else, round them into an array
+    copy.resize(2*(size_t)count);
+    for(int i = 0; i < count; i++){                       // For each city
+      for(int j = 0; j < 2; j++){                           // For each coordinate
+        if(!getValue(data + i*view.strides[0] + j*view.strides[1], *format, copy[2*(size_t)i + j])){
+          PyBuffer_Release(&view);
+          return NULL;
+        }
+      }
+    }
+    xs = copy.data();
+    ys = copy.data() + 1;
+    stride = 2;
+  }
+
+  PLN planner;                                          // Planner of memory representation
+  if(count > EXACT_SIZE && !planner.planDense(count, 1, 1, 1, false, true)){   // If one search object does not fit
+    PyBuffer_Release(&view);
+    return PyErr_NoMemory();
+  }
+
+  vector<int> best(count);                              // Best tour
+  int cost = 0;                                         // Best tour distance
+  bool fits = true;                                     // Arrays fit in memory
+  Py_BEGIN_ALLOW_THREADS                                // Let other Python threads run
+  TSP *obj = NULL;                                      // Algorithm object
+  try{
+    if(count <= EXACT_SIZE){                              // If problem is small enough to solve exactly
+      obj = new EXA;
+    }
+    else if(engine == "ils"){
+      obj = new ILS;
+    }
+    else if(engine == "tempering"){                       // Replicas hold no edge store, so one object is planned
+      obj = new PTE;
+    }
+    else{
+      obj = new GLS;
+    }
+    obj->setSeed(seed);                                   // Set seed of random numbers
+    obj->setMaxTime(seconds);                             // Set time limit
+    obj->setChristofides(planner.christofides);           // Set start tour that fits
+    fits = obj->TSP::setProblem(xs, ys, count, stride);   // Copy cities into solver's arena
+    if(fits){
+      obj->initialize();                                    // Create first tour
+      if(count <= EXACT_SIZE){
+        ((EXA*)obj)->solve();                                 // Solve exactly
+      }
+      else{
+        obj->search();                                        // Run the algorithm
+      }
+      cost = obj->bestCost;
+      std::copy(obj->best, obj->best + count, best.begin());
+    }
+  }
+  catch(std::bad_alloc&){                               // If a vector or heap could not grow
+    fits = false;                                         // Report it as MemoryError, not a crash
+  }
+  delete obj;
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release(&view);
+
+  if(!fits){                                            // If arrays did not fit in memory
+    return PyErr_NoMemory();
+  }
+  PyObject *tour = getTour(best);
+  if(!tour){
+    return NULL;
+  }
+  return Py_BuildValue("(Ni)", tour, cost);
+}
+
+static PyMethodDef methods[] = {
+  {"solve", (PyCFunction)(void(*)(void))solve, METH_VARARGS | METH_KEYWORDS,
+   "solve(coords, seconds=1.0, seed=None, engine='gls') -> (tour, cost)\n\n"
+   "Solve the TSP on an (n, 2) buffer of coordinates within the time limit.\n"
+   "engine is 'gls', 'ils' or 'tempering'. The GIL is released while solving."},
+  {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef module = {
+  PyModuleDef_HEAD_INIT, "tsp", "Guided local search TSP solver.", -1, methods
+};
+
+/********************************************************************************
+ * PyInit_tsp() creates the module when Python imports it.
+********************************************************************************/
+PyMODINIT_FUNC PyInit_tsp(){
+  return PyModule_Create(&module);
+}
@@ -3,12 +3,12 @@
  * CS 325
  * TSP with Christofides
  */
-//#include <cstdlib>
-//#include <vector>
-//#include <string>
+#include <cstdlib>
+#include <vector>
+#include <string>
 #include <functional>
 #include <queue>
-//#include <ctime>
+#include <ctime>
 
 using std::priority_queue;
 using std::vector;
@@ -0,0 +1,478 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the DEC class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "decomposition.hpp"
+#include "gls.hpp"
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+DEC::DEC(){
+  setMaxTime(179);              // Maximum time - specify 180 seconds or INT_MAX
+  setPartSize(1000);            // Solve parts of at most 1,000 cities
+  windowSize = 400;             // Re-optimize windows of 400 cities
+  setThreads(std::thread::hardware_concurrency());   // Use one thread per core
+  profile = NULL;               // Initialize to size table parameters
+  size = 0;                     // Initialize problem size to 0
+  time = 0;                     // Initialize current elapsed time to 0
+  tourCost = 0;                 // Initialize current tour cost to 0
+  x = y = order = tour = NULL;  // Initialize arrays to empty
+}
+
+/********************************************************************************
+ * Deconstructor deletes all dynamically allocated memory
+********************************************************************************/
+DEC::~DEC(){
+  delete [] x;                  // Delete x values
+  delete [] y;                  // Delete y values
+  delete [] order;              // Delete cities grouped by part
+  delete [] tour;               // Delete tour
+}
+
+/********************************************************************************
+ * setMaxTime() initializes the algorithm time limit.
+********************************************************************************/
+void DEC::setMaxTime(double limit){
+  maxTime = limit;
+}
+
+/********************************************************************************
+ * setPartSize() initializes the maximum count of cities in a part.
+********************************************************************************/
+void DEC::setPartSize(int limit){
+  partSize = max(limit, 8);
+}
+
+/********************************************************************************
+ * setThreads() initializes the count of threads solving parts.
+********************************************************************************/
+void DEC::setThreads(int count){
+  threads = max(count, 1);
+}
+
+/********************************************************************************
+ * setProfile() sets the profile that picks the GLS parameters of each part's
+ * search and of the search ordering the parts.
+********************************************************************************/
+void DEC::setProfile(TUN *tuner){
+  profile = tuner;
+}
+
+/********************************************************************************
+ * getDuration() calculates and returns the algorithm's elapsed time.
+********************************************************************************/
+double DEC::getDuration(){
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/********************************************************************************
+ * setProblem() reads in cities from user defined input file into arrays of
+ * city coordinates. No distances are stored.
+********************************************************************************/
+bool DEC::setProblem(string input){
+  start = std::chrono::steady_clock::now();             // Set program timer
+
+  fileName = input;                                     // Initialize filename to user input
+  vector<int> xs, ys;                                   // Hold cities' coordinates
+  string error;                                         // Reason file cannot be read
+  if(!TSP::readCities(fileName, xs, ys, &error)){       // If file cannot be read
+    size = 0;                                             // Reset problem size
+    cout << "ERROR: " << error << endl;                   // Print error message
+    return false;                                         // End function by returning false
+  }
+
+  size = xs.size();                                     // Count cities in file
+  x = new int[size];                                    // Create array for x coordinate values
+  y = new int[size];                                    // Create array for y coordinate values
+  order = new int[size];                                // Create array for cities grouped by part
+  tour = new int[size];                                 // Create tour array
+  for(int i = 0; i < size; i++){                        // For each city
+    x[i] = xs[i];                                         // Copy x and y values
+    y[i] = ys[i];
+    order[i] = i;                                         // Initialize order to file order
+  }
+  return true;                                          // End function by returning true
+}
+
+/********************************************************************************
+ * runAlgorithm() runs the four stages of the decomposition and writes the
+ * resulting tour to the output file.
+********************************************************************************/
+void DEC::runAlgorithm(){
+  parts.clear();                     // Clear any previous parts
+  partition(0, size);                // Split cities into parts
+  parts.push_back(size);             // Mark end of last part
+  solveParts();                      // Solve each part
+  orderParts();                      // Order parts by a tour over their centers
+  stitchParts();                     // Join part tours into one tour
+  optimizeBoundaries();              // Re-optimize around part boundaries
+
+  tourCost = getTourCost();          // Get cost of final tour
+  time = getDuration();              // Get running duration of algorithm
+  outputResults();                   // Call function to print algorithm results
+}
+
+/********************************************************************************
+ * partition() splits the cities in order[lo, hi) at the median of the longer
+ * side of their bounding box until each part has at most partSize cities,
+ * recording the start of each part.
+********************************************************************************/
+void DEC::partition(int lo, int hi){
+  if(hi <= lo){                                         // If there are no cities
+    return;                                               // Record no empty part
+  }
+  if(hi - lo <= partSize){                              // If the cities fit in one part
+    parts.push_back(lo);                                  // Record start of part
+    return;
+  }
+
+  int minX = INT_MAX, maxX = INT_MIN;                   // Bounding box of cities
+  int minY = INT_MAX, maxY = INT_MIN;
+  for(int i = lo; i < hi; i++){                         // For each city
+    minX = min(minX, x[order[i]]);  maxX = max(maxX, x[order[i]]);
+    minY = min(minY, y[order[i]]);  maxY = max(maxY, y[order[i]]);
+  }
+
+  int *coordinate = (maxX - minX >= maxY - minY) ? x : y;   // Split along longer side
+  int mid = lo + (hi - lo)/2;                           // Median position
+  std::nth_element(order + lo, order + mid, order + hi,
+                   [coordinate](int a, int b){ return coordinate[a] < coordinate[b]; });
+
+  partition(lo, mid);                                   // Split lower half
+  partition(mid, hi);                                   // Split upper half
+}
+
+/********************************************************************************
+ * solveParts() runs a GLS object on each part, with threads taking the next
+ * unsolved part until all are solved, and stores each part's best tour back
+ * into its range of the order array. 70% of the time limit is shared between
+ * the parts.
+********************************************************************************/
+void DEC::solveParts(){
+  int count = parts.size() - 1;                         // Count of parts
+  int workers = min(threads, count);                    // Count of threads needed
+  double budget = max(0.05, (0.7*maxTime - getDuration())*workers/count);   // Time limit of each part
+  int cores = max(1, (int)std::thread::hardware_concurrency() / max(workers, 1));   // Threads each part fills its rows with
+  std::atomic<int> next(0);                             // Next part to solve
+
+  auto worker = [&](){                                  // Solve parts until none are left
+    vector<int> xs, ys;                                   // Part's coordinates
+    for(int p = next++; p < count; p = next++){           // For each part taken by this thread
+      int first = parts[p];                                 // Start of part in order
+      int length = parts[p+1] - first;                      // Count of cities in part
+      if(length < 8){                                       // If part is too small to search
+        continue;                                             // Keep cities in current order
+      }
+      xs.resize(length);
+      ys.resize(length);
+      for(int i = 0; i < length; i++){                      // For each city in part
+        xs[i] = x[order[first + i]];                          // Copy x value
+        ys[i] = y[order[first + i]];                          // Copy y value
+      }
+
+      GLS solver;                                           // Create an algorithm object for the part
+      solver.setMaxTime(budget);                            // Set part's time limit
+      solver.setRowThreads(cores);                          // Share cores with the other workers
+      solver.setProblem(xs.data(), ys.data(), length);      // Initialize part's cities
+      solver.initialize();                                  // Initialize dynamic arrays
+      if(profile){                                          // If a profile is set
+        profile->setParameters(solver);                       // Apply its parameters
+      }
+      solver.search();                                      // Run the algorithm
+
+      vector<int> cities(order + first, order + first + length);
+      for(int i = 0; i < length; i++){                      // For each city in part's best tour
+        order[first + i] = cities[solver.best[i]];            // Map back to city ID
+      }
+    }
+  };
+
+  vector<std::thread> pool;                             // Worker threads
+  for(int t = 1; t < workers; t++){                     // For each extra thread
+    pool.push_back(std::thread(worker));                  // Start worker
+  }
+  worker();                                             // Work on this thread too
+  for(unsigned t = 0; t < pool.size(); t++){            // For each extra thread
+    pool[t].join();                                       // Wait for worker to finish
+  }
+}
+
+/********************************************************************************
+ * orderParts() finds the order to visit the parts in by running GLS on a
+ * problem made of the parts' centers.
+********************************************************************************/
+void DEC::orderParts(){
+  int count = parts.size() - 1;                         // Count of parts
+  partOrder.resize(count);
+  for(int p = 0; p < count; p++){                       // For each part
+    partOrder[p] = p;                                     // Initialize to partition order
+  }
+  if(count < 8){                                        // If there are too few parts to search
+    return;                                               // Keep partition order
+  }
+
+  vector<int> xs(count), ys(count);                     // Parts' centers
+  for(int p = 0; p < count; p++){                       // For each part
+    long sumX = 0, sumY = 0;                              // Sum of part's coordinates
+    for(int i = parts[p]; i < parts[p+1]; i++){           // For each city in part
+      sumX += x[order[i]];
+      sumY += y[order[i]];
+    }
+    xs[p] = sumX/(parts[p+1] - parts[p]);                 // Record center of part
+    ys[p] = sumY/(parts[p+1] - parts[p]);
+  }
+
+  GLS solver;                                           // Create an algorithm object for the centers
+  solver.setMaxTime(min(2.0, 0.05*maxTime));            // Give it a small share of the time limit
+  solver.setProblem(xs.data(), ys.data(), count);       // Initialize centers as cities
+  solver.initialize();                                  // Initialize dynamic arrays
+  if(profile){                                          // If a profile is set
+    profile->setParameters(solver);                       // Apply its parameters
+  }
+  solver.search();                                      // Run the algorithm
+  for(int p = 0; p < count; p++){                       // For each part in best tour
+    partOrder[p] = solver.best[p];                        // Record its place in the order
+  }
+}
+
+/********************************************************************************
+ * stitchParts() joins the part tours in partOrder into one tour. Each part's
+ * cycle is cut at the edge that best connects the previous part's exit city
+ * to the next part's center, and the cycle is walked in the cheaper direction.
+ * Empty parts are skipped.
+********************************************************************************/
+void DEC::stitchParts(){
+  vector<int> filled;                                   // Parts in order, without empty ones
+  for(unsigned k = 0; k < partOrder.size(); k++){
+    if(parts[partOrder[k]+1] > parts[partOrder[k]]){      // If part has cities
+      filled.push_back(partOrder[k]);
+    }
+  }
+  int count = filled.size();                            // Count of parts
+  int length = 0;                                       // Count of cities placed in tour
+  double prevX, prevY;                                  // Position of previous exit
+  junctions.clear();
+
+  if(count == 0){                                       // If no part has cities
+    return;
+  }
+
+  vector<double> centerX(parts.size()), centerY(parts.size());   // Parts' centers
+  for(int k = 0; k < count; k++){                       // For each part
+    int p = filled[k];
+    double sumX = 0, sumY = 0;
+    for(int i = parts[p]; i < parts[p+1]; i++){
+      sumX += x[order[i]];
+      sumY += y[order[i]];
+    }
+    centerX[p] = sumX/(parts[p+1] - parts[p]);
+    centerY[p] = sumY/(parts[p+1] - parts[p]);
+  }
+  prevX = centerX[filled[count-1]];                     // Enter first part from the last part
+  prevY = centerY[filled[count-1]];
+
+  auto pointDistance = [&](double px, double py, int city){   // Distance from point to city
+    return sqrt(pow(px - x[city], 2) + pow(py - y[city], 2));
+  };
+
+  for(int k = 0; k < count; k++){                       // For each part in order
+    int p = filled[k];                                    // Get part
+    int q = filled[(k+1) % count];                        // Get next part
+    int *cycle = order + parts[p];                        // Part's cycle
+    int m = parts[p+1] - parts[p];                        // Count of cities in part
+
+    double bestCut = 1e300;                               // Cost of best cut found
+    int cut = 0;                                          // Position of best cut
+    bool forward = true;                                  // Direction of best cut
+    for(int i = 0; i < m; i++){                           // For each edge in cycle
+      int a = cycle[i];                                     // Edge's first city
+      int b = cycle[(i+1) % m];                             // Edge's second city
+      double removed = getDistance(a, b);                   // Cost of removed edge
+      double enterB = pointDistance(prevX, prevY, b) + pointDistance(centerX[q], centerY[q], a) - removed;
+      double enterA = pointDistance(prevX, prevY, a) + pointDistance(centerX[q], centerY[q], b) - removed;
+      if(enterB < bestCut){                                 // If entering at b and leaving at a is best
+        bestCut = enterB;  cut = i;  forward = true;
+      }
+      if(enterA < bestCut){                                 // If entering at a and leaving at b is best
+        bestCut = enterA;  cut = i;  forward = false;
+      }
+    }
+
+    junctions.push_back(length);                          // Record where part begins
+    for(int j = 0; j < m; j++){                           // For each city in part
+      if(forward){                                          // Walk from b around to a
+        tour[length++] = cycle[(cut + 1 + j) % m];
+      }
+      else{                                                 // Walk from a back around to b
+        tour[length++] = cycle[((cut - j) % m + m) % m];
+      }
+    }
+    prevX = x[tour[length-1]];                            // Record exit city
+    prevY = y[tour[length-1]];
+  }
+}
+
+/********************************************************************************
+ * optimizeBoundaries() re-optimizes windows of the tour centered on the part
+ * boundaries, then windows shifted by half a window so that the edges at the
+ * ends of the first windows are covered too, alternating until the time limit
+ * is reached or a round makes no improvement. Windows in a round do not
+ * overlap, so they are optimized in parallel.
+********************************************************************************/
+void DEC::optimizeBoundaries(){
+  int count = junctions.size();                         // Count of boundaries
+  int window = min(windowSize, size);                   // Cities in a window
+  for(int k = 0; k < count; k++){                       // For each boundary
+    int gap = junctions[(k+1) % count] - junctions[k];    // Cities until next boundary
+    if(gap <= 0){
+      gap += size;
+    }
+    window = min(window, gap);                            // Keep windows from overlapping
+  }
+  if(window < 8){                                       // If windows are too small to optimize
+    return;
+  }
+
+  bool improved = true;                                 // Track if a round improved the tour
+  for(int round = 0; improved && getDuration() < maxTime; round++){   // While rounds improve the tour
+    int offset = (round % 2 == 0) ? -window/2 : 0;        // Center on boundaries, then shift by half
+    std::atomic<int> next(0);                             // Next window to optimize
+    std::atomic<bool> changed(false);                     // Track if any window improved
+
+    auto worker = [&](){                                  // Optimize windows until none are left
+      for(int k = next++; k < count && getDuration() < maxTime; k = next++){
+        if(optimizeWindow(((junctions[k] + offset) % size + size) % size, window)){
+          changed = true;
+        }
+      }
+    };
+
+    vector<std::thread> pool;                             // Worker threads
+    for(int t = 1; t < min(threads, count); t++){         // For each extra thread
+      pool.push_back(std::thread(worker));                  // Start worker
+    }
+    worker();                                             // Work on this thread too
+    for(unsigned t = 0; t < pool.size(); t++){            // For each extra thread
+      pool[t].join();                                       // Wait for worker to finish
+    }
+    improved = changed || round == 0;                     // Always run both window offsets once
+  }
+}
+
+/********************************************************************************
+ * optimizeWindow() treats length cities of the tour starting at position
+ * first as a path with fixed ends, and applies improving 2-opt and Or-opt
+ * moves to it until none are left. Returns whether the path was improved.
+********************************************************************************/
+bool DEC::optimizeWindow(int first, int length){
+  vector<int> path(length);                             // Cities in window
+  for(int i = 0; i < length; i++){                      // For each place in window
+    path[i] = tour[(first + i) % size];                   // Copy city
+  }
+  vector<int> dist((long)length*length);                // Distances between window's cities
+  for(int i = 0; i < length; i++){
+    for(int j = 0; j < length; j++){
+      dist[(long)i*length + j] = getDistance(path[i], path[j]);
+    }
+  }
+  vector<int> place(length);                            // Window index of each path position
+  for(int i = 0; i < length; i++){
+    place[i] = i;
+  }
+  auto d = [&](int a, int b){                           // Distance between path positions
+    return dist[(long)place[a]*length + place[b]];
+  };
+
+  bool improved = false;                                // Track if path was improved
+  bool found = true;                                    // Track if a pass found a move
+  while(found && getDuration() < maxTime){              // While moves are found
+    found = false;
+    for(int i = 0; i < length - 3; i++){                  // 2-opt: for each first edge
+      for(int j = i + 2; j < length - 1; j++){              // For each later edge
+        if(d(i, j) + d(i+1, j+1) < d(i, i+1) + d(j, j+1)){    // If reconnecting is shorter
+          std::reverse(place.begin() + i + 1, place.begin() + j + 1);
+          found = true;
+        }
+      }
+    }
+    for(int seg = 1; seg <= 3; seg++){                    // Or-opt: for each segment length
+      for(int i = 1; i + seg < length; i++){                // For each segment not holding an end
+        int e = i + seg - 1;                                  // Last position of segment
+        int gain = d(i-1, i) + d(e, e+1) - d(i-1, e+1);       // Gain of removing segment
+        for(int k = 0; k < length - 1; k++){                  // For each edge to insert between
+          if(k >= i - 1 && k <= e){                             // If edge touches segment
+            continue;
+          }
+          int added = d(k, i) + d(e, k+1) - d(k, k+1);          // Cost of inserting segment forward
+          int reversed = d(k, e) + d(i, k+1) - d(k, k+1);       // Cost of inserting segment reversed
+          if(min(added, reversed) < gain){                      // If moving segment is shorter
+            if(k < i){                                            // Move segment back
+              std::rotate(place.begin() + k + 1, place.begin() + i, place.begin() + e + 1);
+              if(reversed < added){
+                std::reverse(place.begin() + k + 1, place.begin() + k + 1 + seg);
+              }
+            }
+            else{                                                 // Move segment forward
+              std::rotate(place.begin() + i, place.begin() + e + 1, place.begin() + k + 1);
+              if(reversed < added){
+                std::reverse(place.begin() + k + 1 - seg, place.begin() + k + 1);
+              }
+            }
+            found = true;
+            break;
+          }
+        }
+      }
+    }
+    improved = improved || found;
+  }
+
+  for(int i = 0; i < length; i++){                      // For each place in window
+    tour[(first + i) % size] = path[place[i]];            // Write optimized city back
+  }
+  return improved;
+}
+
+/********************************************************************************
+ * getDistance() calculates the rounded Euclidean distance between two cities.
+********************************************************************************/
+int DEC::getDistance(int c1, int c2){
+  return TSP::getDistance(x[c1], y[c1], x[c2], y[c2]);
+}
+
+/********************************************************************************
+ * getTourCost() calculates and returns the cost of the current tour.
+********************************************************************************/
+long DEC::getTourCost(){
+  long cost = 0;                                        // Initialize cost to 0
+  for(int i = 0; i < size; i++){                       // For each city
+    cost += getDistance(tour[i], tour[(i+1) % size]);     // Add distance to next city
+  }
+  return cost;                                          // Return total cost
+}
+
+/********************************************************************************
+ * outputResults() writes the cost and tour to an output file, and prints the
+ * final time and cost to the terminal.
+********************************************************************************/
+void DEC::outputResults(){
+  outputFile.open((fileName + ".tour").c_str());   // Create output file
+
+  outputFile << tourCost << "\n";                  // Write cost to file
+  for(int i = 0; i < size; i++){                   // For each city in tour
+    outputFile << tour[i] << "\n";                   // Write city identifier file
+  }
+  outputFile.close();                              // Close output file
+
+  cout << "Parts: " << parts.size() - 1 << "    "
+		  "Best Tour: " << tourCost << "   "
+		  "Total Time(sec): " << time << endl;
+}
@@ -0,0 +1,71 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The DEC class solves instances too large for the n x n
+ *              distance and penalty matrices of the TSP and GLS classes.
+ *              Cities are partitioned spatially by recursive bisection,
+ *              each part is solved in parallel by its own GLS object, the
+ *              part tours are stitched into one tour in the order of a
+ *              small tour over the parts' centers, and windows of the tour
+ *              around the part boundaries are re-optimized with 2-opt and
+ *              Or-opt. Only O(n) memory is used for the whole instance.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef DECOMPOSITION_HPP
+#define DECOMPOSITION_HPP
+
+#include <vector>
+#include "tsp.hpp"
+#include "tuning.hpp"
+
+using std::vector;
+
+class DEC{
+  public:
+	double maxTime;          // Time limit
+	int	size;                // Size of problem (count of cities)
+	int partSize;            // Maximum count of cities in a part
+	int windowSize;          // Count of cities in a boundary window
+	int threads;             // Count of threads solving parts
+	TUN *profile;            // Parameters of part searches, or NULL for size tables
+	double time;             // Current time
+	long tourCost;           // Current tour distance
+
+	int *x;                  // Cities' x values
+	int *y;                  // Cities' y values
+	int *order;              // Cities grouped by part
+	int *tour;               // Current tour
+	vector<int> parts;       // Start of each part in order, plus end of last part
+	vector<int> partOrder;   // Order parts are visited in
+	vector<int> junctions;   // Tour positions where a new part begins
+
+	ofstream outputFile;     // Output file object
+	string fileName;         // Input file name
+
+	std::chrono::steady_clock::time_point start;   // Algorithm start time
+
+  public:
+	DEC();                                     // Constructor
+	~DEC();                                    // Deconstructor
+
+	void setMaxTime(double);                   // Set max time for running algorithm
+	void setPartSize(int);                     // Set max count of cities in a part
+	void setThreads(int);                      // Set count of threads solving parts
+	void setProfile(TUN*);                     // Set profile picking parameters of part searches
+	double getDuration();                      // Get algorithm elapsed time
+
+	bool setProblem(string);                   // Read record of cities
+	void runAlgorithm();                       // Run the algorithm
+
+	void partition(int, int);                  // Recursively bisect cities into parts
+	void solveParts();                         // Solve each part with GLS in parallel
+	void orderParts();                         // Find order to visit parts in
+	void stitchParts();                        // Join part tours into one tour
+	void optimizeBoundaries();                 // Re-optimize windows around part boundaries
+	bool optimizeWindow(int, int);             // 2-opt and Or-opt a window of the tour
+
+	int getDistance(int, int);                 // Get distance between two cities
+	long getTourCost();                        // Get cost of current tour
+	void outputResults();                      // Write tour to output file
+};
+#endif
@@ -0,0 +1,256 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the DYN class. Here, you
+ *              can find initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include <sstream>
+#include "dynamic.hpp"
+
+/********************************************************************************
+ * Constructor initializes driving variables.
+********************************************************************************/
+DYN::DYN(){
+  setRegionSize(50);         // Search the 50 nearest cities around each change
+}
+
+/********************************************************************************
+ * setRegionSize() initializes the count of nearest cities searched around
+ * each affected city to programmer's input.
+********************************************************************************/
+void DYN::setRegionSize(int count){
+  regionSize = count;
+}
+
+/********************************************************************************
+ * setProblem() reads the previous instance, its tour and the delta file,
+ * builds the updated cities with removed cities dropped and added cities
+ * appended, records the previous tour in the updated IDs, and writes the
+ * updated instance to "[instance].updated". The output tour is written to
+ * "[instance].updated.tour".
+********************************************************************************/
+bool DYN::setProblem(string instance, string tourFile, string deltaFile){
+  vector<int> xs, ys;                                   // Previous cities' coordinates
+  ifstream tourIn(tourFile), deltaIn(deltaFile);
+  string error = "FILE NOT FOUND";                      // Reason a file cannot be read
+  if(!readCities(instance, xs, ys, &error) || !tourIn || !deltaIn){   // If a file cannot be read
+    cout << "ERROR: " << error << endl;                   // Print error message
+    return false;                                         // End function by returning false
+  }
+  int count = xs.size();                                // Count of previous cities
+  int null;                                             // Holds previous tour cost
+
+  vector<int> previous;                                 // Previous tour
+  vector<char> visited(count, 0);                       // Cities already in previous tour
+  int city;
+  if(!(tourIn >> null)){                                // Skip previous tour cost
+    cout << "ERROR: TOUR DOES NOT MATCH INSTANCE" << endl;
+    return false;
+  }
+  while(tourIn >> city){                                // For each city in previous tour
+    if(city < 0 || city >= count || visited[city]){       // If city is not in previous instance or repeats
+      cout << "ERROR: TOUR DOES NOT MATCH INSTANCE" << endl;
+      return false;
+    }
+    visited[city] = 1;
+    previous.push_back(city);
+  }
+  if((int)previous.size() != count || !tourIn.eof()){   // If tour does not visit every city
+    cout << "ERROR: TOUR DOES NOT MATCH INSTANCE" << endl;
+    return false;
+  }
+
+  vector<char> removed(count, 0), moved(count, 0);      // Previous cities removed or moved
+  vector<int> addedX, addedY;                           // Added cities' coordinates
+  string line;
+  int number = 0;                                       // Line number in delta file
+  while(getline(deltaIn, line)){                        // For each line in delta file
+    number++;
+    std::istringstream in(line);
+    string change, rest;
+    int id = 0, x = 0, y = 0;
+    if(!(in >> change)){                                  // If line is blank
+      continue;
+    }
+    bool read;                                            // Whether the line's numbers were read
+    if(change == "a"){                                    // If city is added
+      read = (bool)(in >> x >> y);
+    }
+    else if(change == "r"){                               // If city is removed
+      read = (bool)(in >> id);
+    }
+    else if(change == "m"){                               // If city is moved
+      read = (bool)(in >> id >> x >> y);
+    }
+    else{                                                 // Else, change is not known
+      cout << "ERROR: UNKNOWN CHANGE IN DELTA: " << change << endl;
+      return false;
+    }
+    if(!read || in >> rest){                              // If numbers are missing or follow
+      cout << "ERROR: BAD DELTA LINE " << number << endl;
+      return false;
+    }
+    if(change == "a"){
+      addedX.push_back(x);
+      addedY.push_back(y);
+      continue;
+    }
+    if(id < 0 || id >= count){                            // If city is not in previous instance
+      cout << "ERROR: UNKNOWN CITY IN DELTA: " << id << endl;
+      return false;
+    }
+    if(removed[id] || moved[id]){                         // If city was already changed
+      cout << "ERROR: CITY CHANGED TWICE IN DELTA: " << id << endl;
+      return false;
+    }
+    if(change == "r"){
+      removed[id] = 1;
+    }
+    else{
+      xs[id] = x;
+      ys[id] = y;
+      moved[id] = 1;
+    }
+  }
+
+  vector<int> newId(count, -1);                         // Updated ID of each previous city
+  vector<int> updatedX, updatedY;                       // Updated cities' coordinates
+  for(int i = 0; i < count; i++){                       // For each previous city
+    if(!removed[i]){                                      // If it is kept
+      newId[i] = updatedX.size();
+      updatedX.push_back(xs[i]);
+      updatedY.push_back(ys[i]);
+    }
+  }
+  for(unsigned i = 0; i < addedX.size(); i++){          // For each added city
+    inserted.push_back(updatedX.size());                  // Insert it into tour
+    affected.push_back(updatedX.size());
+    updatedX.push_back(addedX[i]);
+    updatedY.push_back(addedY[i]);
+  }
+  if(updatedX.size() < 5){                              // If too few cities are left to search
+    cout << "ERROR: TOO FEW CITIES" << endl;
+    return false;
+  }
+
+  vector<char> leaves(count, 0);                        // Previous cities leaving their place in tour
+  for(int i = 0; i < count; i++){
+    leaves[i] = removed[i] || moved[i];
+  }
+  for(int i = 0; i < count; i++){                       // For each city in previous tour
+    int c = previous[i];
+    int before = previous[(i + count - 1) % count];
+    if(leaves[c] && !leaves[before]){                     // If city starts a run of cities leaving
+      int j = i;                                            // Walk to first city after the run
+      for(int step = 0; step < count && leaves[previous[j]]; step++){
+        j = (j + 1) % count;
+      }
+      affected.push_back(newId[before]);                    // The cities around the run share a new edge
+      affected.push_back(newId[previous[j]]);
+    }
+    if(moved[c] && !removed[c]){                          // If city is moved
+      inserted.push_back(newId[c]);                         // Reinsert it
+      affected.push_back(newId[c]);
+    }
+    else if(!removed[c]){                                 // Else, if city is unchanged
+      startTour.push_back(newId[c]);                        // Keep its place in tour
+    }
+  }
+
+  if(!TSP::setProblem(updatedX.data(), updatedY.data(), updatedX.size())){   // If updated cities cannot be initialized
+    return false;
+  }
+  fileName = instance + ".updated";                     // Name updated instance
+
+  ofstream updated(fileName.c_str());                   // Write updated instance
+  for(int i = 0; i < size; i++){
+    updated << i << " " << x[i] << " " << y[i] << "\n";
+  }
+  return true;                                          // End function by returning true
+}
+
+/********************************************************************************
+ * getArenaSize() adds the bytes of the searched region to the GLS class's
+ * arrays.
+********************************************************************************/
+size_t DYN::getArenaSize(){
+  return GLS::getArenaSize() + Arena::align(size*sizeof(bool));
+}
+
+/********************************************************************************
+ * initialize() repairs the previous tour instead of creating a random or
+ * Christofides tour, marks the searched region, and creates the GLS arrays.
+********************************************************************************/
+void DYN::initialize(){
+  insertCities();                        // Repair previous tour
+  tourCost = getTourCost(tour);          // Get the cost of the tour
+  setBest();                             // Set the best tour as current tour
+  setRegion();                           // Limit search to cities near changes
+  initializeSearch();                    // Create GLS arrays
+
+  int searched = 0;                      // Count of searched cities
+  for(int i = 0; i < size; i++){
+    searched += active[i];
+  }
+  cout << "Repaired Tour: " << tourCost << "   "
+          "Searched Cities: " << searched << endl;
+}
+
+/********************************************************************************
+ * insertCities() copies the previous tour into the tour array and inserts
+ * each added or moved city between the two neighboring cities where it adds
+ * the least distance.
+********************************************************************************/
+void DYN::insertCities(){
+  int length = startTour.size();                        // Count of cities in tour
+  for(int i = 0; i < length; i++){                      // For each city in previous tour
+    tour[i] = startTour[i];                               // Copy city
+  }
+
+  for(unsigned k = 0; k < inserted.size(); k++){        // For each city to insert
+    int c = inserted[k];
+    int place = length;                                   // Place to insert city after
+    int cheapest = INT_MAX;                               // Cost of cheapest place
+    for(int i = 0; i < length; i++){                      // For each edge in tour
+      int a = tour[i], b = tour[(i + 1) % length];
+      int cost = distance[a][c] + distance[c][b] - distance[a][b];
+      if(cost < cheapest){                                  // If edge is the cheapest place so far
+        cheapest = cost;
+        place = i + 1;
+      }
+    }
+    for(int i = length; i > place; i--){                  // Make room after cheapest edge
+      tour[i] = tour[i - 1];
+    }
+    tour[place] = c;                                      // Insert city
+    length++;
+  }
+}
+
+/********************************************************************************
+ * setRegion() marks each affected city and its nearest cities as searched.
+********************************************************************************/
+void DYN::setRegion(){
+  active = arena.allocate<bool>(size);                  // Create array for searched cities
+  for(int i = 0; i < size; i++){
+    active[i] = false;
+  }
+
+  vector<int> nearest(size);                            // Cities ordered by distance
+  int count = min(regionSize, size - 1);                // Count of nearest cities per change
+  for(unsigned k = 0; k < affected.size(); k++){        // For each affected city
+    int c = affected[k];
+    active[c] = true;                                     // Search it
+    for(int i = 0; i < size; i++){
+      nearest[i] = i;
+    }
+    std::nth_element(nearest.begin(), nearest.begin() + count, nearest.end(),
+                     [this, c](int a, int b){ return distance[c][a] < distance[c][b]; });
+    for(int i = 0; i <= count; i++){                      // For each nearest city, including itself
+      active[nearest[i]] = true;                            // Search it
+    }
+  }
+}
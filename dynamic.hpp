@@ -0,0 +1,45 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The DYN class re-optimizes a previous tour after a handful of
+ *              cities were added, removed or moved. It applies a delta file
+ *              to the previous instance, repairs the previous tour by dropping
+ *              removed cities and inserting added and moved ones at their
+ *              cheapest place, and runs GLS limited to the region around the
+ *              changes: only cities near an affected city are searched and
+ *              only edges touching them are penalized.
+ *
+ *              Delta file lines, with IDs from the previous instance:
+ *                a x y     add a city at (x, y)
+ *                r id      remove city id
+ *                m id x y  move city id to (x, y)
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef DYNAMIC_HPP
+#define DYNAMIC_HPP
+
+#include <vector>
+#include "gls.hpp"
+
+using std::vector;
+
+class DYN: public GLS{
+  public:
+	int regionSize;          // Count of nearest cities searched around each affected city
+
+	vector<int> startTour;   // Previous tour in new city IDs, without cities to insert
+	vector<int> inserted;    // Cities to insert into previous tour
+	vector<int> affected;    // Cities next to a change
+
+  public:
+	DYN();                                     // Constructor
+
+	void setRegionSize(int);                   // Set count of nearest cities searched per change
+
+	bool setProblem(string, string, string);   // Apply delta to previous instance and tour
+	size_t getArenaSize();                     // Get bytes needed by all arrays
+	void initialize();                         // Repair tour and initialize dynamic arrays
+	void insertCities();                       // Insert cities at their cheapest place
+	void setRegion();                          // Mark cities near changes as searched
+};
+#endif
@@ -0,0 +1,437 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the EXA class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include <immintrin.h>
+#include "exact.hpp"
+#include "gls.hpp"
+
+#define HELD_KARP_INF (INT_MAX/2)  // Cost of a path that does not exist
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+EXA::EXA(){
+  proven = false;               // Initialize to no proof
+  nodes = 0;                    // Initialize count of visited nodes to 0
+  width = 0;                    // Initialize to no subset table
+  table = rows = NULL;          // Initialize arrays to empty
+  stop = 0;                     // Initialize stop time to 0
+  simd = __builtin_cpu_supports("avx2") ? 1 : 0;   // Use AVX2 if CPU has it
+}
+
+/********************************************************************************
+ * getArenaSize() adds the bytes of the Held-Karp table and padded distance
+ * rows when the problem is small enough to use them.
+********************************************************************************/
+size_t EXA::getArenaSize(){
+  size_t bytes = TSP::getArenaSize();
+  width = (size - 1 + HELD_KARP_LANES - 1) / HELD_KARP_LANES * HELD_KARP_LANES;   // Last cities, padded
+  if(size > 3 && size <= HELD_KARP_SIZE){              // If problem uses dynamic program
+    bytes += Arena::align(((size_t)1 << (size-1)) * width * sizeof(int));   // Subset table
+    bytes += Arena::align(size * width * sizeof(int));                     // Padded rows
+  }
+  return bytes;
+}
+
+/********************************************************************************
+ * initialize() creates a nearest neighbor tour from city 0 and copies it to
+ * the best tour.
+********************************************************************************/
+void EXA::initialize(){
+  std::vector<bool> visited(size, false);
+  tour[0] = 0;
+  visited[0] = true;
+  for(int i = 1; i < size; i++){                        // For each place in the tour
+    int last = tour[i-1], next = -1;
+    for(int c = 0; c < size; c++){                        // Find nearest unvisited city
+      if(!visited[c] && (next < 0 || distance[last][c] < distance[last][next])){
+        next = c;
+      }
+    }
+    tour[i] = next;
+    visited[next] = true;
+  }
+  tourCost = getTourCost(tour);      // Get the cost of the tour
+  setBest();                         // Set the best tour as current tour
+}
+
+/********************************************************************************
+ * runAlgorithm() solves the problem, records the finish time, and writes the
+ * results.
+********************************************************************************/
+void EXA::runAlgorithm(){
+  solve();                           // Solve problem exactly
+  time = getDuration();              // Get running duration of algorithm
+  iteration = nodes;                 // Report visited nodes as iterations
+  outputResults();                   // Call function to print algorithm results
+  cout << "Optimal: " << (proven ? "proven" : "not proven, best of branch and bound and GLS") << endl;
+}
+
+/********************************************************************************
+ * solve() picks the exact method for the problem size. Problems of three or
+ * fewer cities have only one tour. If branch and bound stops unproven, GLS
+ * searches for the rest of the time limit.
+********************************************************************************/
+void EXA::solve(){
+  if(size <= 3){                     // If there is only one tour
+    proven = true;
+  }
+  else if(size <= HELD_KARP_SIZE){   // Else, if the subset table is small
+    solveHeldKarp();                   // Solve by dynamic programming
+  }
+  else{                              // Else
+    solveBranchAndBound();             // Solve by branch and bound
+    if(!proven){                       // If it stopped before proving its tour
+      searchRest();                      // Search by GLS for the rest of the time
+    }
+  }
+}
+
+/********************************************************************************
+ * solveHeldKarp() finds the cheapest path from city 0 through each subset S
+ * of the other cities ending at each city k of S, as the minimum over the
+ * cities j of S - {k} of the cheapest path through S - {k} ending at j plus
+ * the distance from j to k. Paths through cities not in a subset cost
+ * HELD_KARP_INF, and each subset's row is padded to a multiple of
+ * HELD_KARP_LANES, so the minimum is taken over a whole row with no test of
+ * membership. The tour is
+ * rebuilt by walking back through the table.
+********************************************************************************/
+void EXA::solveHeldKarp(){
+  int m = size - 1;                                     // Cities 1..m are subset bits 0..m-1
+  int full = (1 << m) - 1;                              // Subset of all cities
+  table = arena.allocate<int>(((size_t)1 << m) * width);
+  rows = arena.allocate<int>(size * width);
+
+  for(int k = 0; k < m; k++){                           // For each city
+    for(int j = 0; j < width; j++){                       // Pad distances from it to a full row
+      rows[k*width + j] = j < m ? distance[k+1][j+1] : 0;
+    }
+  }
+  std::fill(table, table + ((size_t)1 << m) * width, HELD_KARP_INF);
+  for(int k = 0; k < m; k++){                           // For each single city subset
+    table[(size_t)(1 << k)*width + k] = distance[0][k+1];   // Path from city 0
+  }
+
+  for(int subset = 1; subset <= full; subset++){        // For each subset, smaller subsets first
+    if(!(subset & (subset - 1))){                         // If subset has one city
+      continue;
+    }
+    for(int bits = subset; bits; bits &= bits - 1){       // For each last city of subset
+      int k = __builtin_ctz(bits);
+      const int *previous = table + (size_t)(subset ^ (1 << k))*width;
+      table[(size_t)subset*width + k] = simd ? getRowMinAVX2(previous, rows + k*width)
+                                             : getRowMin(previous, rows + k*width);
+    }
+  }
+  nodes = (long)full * m;
+
+  int last = 0;                                         // Last city of cheapest tour
+  bestCost = INT_MAX;
+  for(int k = 0; k < m; k++){                           // For each last city
+    int cost = table[(size_t)full*width + k] + distance[k+1][0];   // Close tour
+    if(cost < bestCost){
+      bestCost = cost;
+      last = k;
+    }
+  }
+
+  int subset = full;
+  for(int place = size - 1; place > 0; place--){        // For each place, last first
+    best[place] = last + 1;                               // Record city
+    int cost = table[(size_t)subset*width + last];
+    subset ^= 1 << last;                                  // Remove city from subset
+    for(int j = 0; j < m && subset; j++){                 // Find city before it
+      if((subset & (1 << j)) &&
+         table[(size_t)subset*width + j] + distance[j+1][last+1] == cost){
+        last = j;
+        break;
+      }
+    }
+  }
+  best[0] = 0;
+  proven = true;
+}
+
+/********************************************************************************
+ * getRowMin() returns the minimum of the sums of two rows of width ints.
+********************************************************************************/
+int EXA::getRowMin(const int *a, const int *b){
+  int least = INT_MAX;
+  for(int j = 0; j < width; j++){
+    least = min(least, a[j] + b[j]);
+  }
+  return least;
+}
+
+/********************************************************************************
+ * getRowMinAVX2() returns the minimum of the sums of two rows of width ints,
+ * adding and comparing 8 at a time.
+********************************************************************************/
+__attribute__((target("avx2")))
+int EXA::getRowMinAVX2(const int *a, const int *b){
+  __m256i least = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)a),
+                                   _mm256_loadu_si256((const __m256i*)b));
+  for(int j = 8; j < width; j += 8){                    // For each further 8 ints
+    __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(a + j)),
+                                   _mm256_loadu_si256((const __m256i*)(b + j)));
+    least = _mm256_min_epi32(least, sum);                 // 8 lanes
+  }
+  __m128i half = _mm_min_epi32(_mm256_castsi256_si128(least),           // 4 lanes
+                               _mm256_extracti128_si256(least, 1));
+  half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));   // 2 lanes
+  half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));   // 1 lane
+  return _mm_cvtsi128_si32(half);
+}
+
+/********************************************************************************
+ * solveBranchAndBound() improves the first tour to an upper bound, finds the
+ * Lagrangian weights, and searches every path from city 0 whose bound is
+ * below the best tour. The best tour is optimal unless the search is stopped
+ * at half the time limit or after BRANCH_SECONDS.
+********************************************************************************/
+void EXA::solveBranchAndBound(){
+  stop = min(maxTime / 2, (double)BRANCH_SECONDS);      // Leave the rest of the time to GLS
+  setUpperBound();                                      // Get a good first tour
+  setWeights();                                         // Tighten spanning tree bounds
+  proven = true;                                        // Cleared if time limit stops search
+  path.assign(1, 0);                                    // Path starts at city 0
+  branch(0, 0, 1);                                      // Search all paths
+}
+
+/********************************************************************************
+ * searchRest() runs GLS on the cities for the rest of the time limit, and
+ * keeps its tour if it is better than the one branch and bound found.
+********************************************************************************/
+void EXA::searchRest(){
+  GLS obj;                                              // Create a GLS object
+  obj.setHugePages(hugePages);                          // Set page size of arena
+  obj.setMaxTime(max(maxTime - getDuration(), 0.0));    // Search for the rest of the time
+  if(!obj.TSP::setProblem(x, y, size)){                 // If cities do not fit in memory
+    return;
+  }
+  obj.initialize();                                     // Create first tour
+  obj.search();                                         // Run the algorithm
+  nodes += obj.iteration;
+  if(obj.bestCost < bestCost){                          // If GLS found a better tour
+    bestCost = obj.bestCost;
+    std::copy(obj.best, obj.best + size, best);
+  }
+}
+
+/********************************************************************************
+ * setUpperBound() improves the nearest neighbor tour by 2-opt until no swap
+ * shortens it.
+********************************************************************************/
+void EXA::setUpperBound(){
+  bool improved = true;
+  while(improved){                                      // While a swap shortens the tour
+    improved = false;
+    for(int i = 0; i < size - 1; i++){                    // For each pair of tour edges
+      for(int j = i + 2; j < size; j++){
+        int a = best[i], b = best[i+1], c = best[j], d = best[(j+1) % size];
+        if(a == d){
+          continue;
+        }
+        if(distance[a][c] + distance[b][d] < distance[a][b] + distance[c][d]){
+          std::reverse(best + i + 1, best + j + 1);         // Swap edges
+          improved = true;
+        }
+      }
+    }
+  }
+  bestCost = getTourCost(best);
+}
+
+/********************************************************************************
+ * getOneTree() returns the weighted cost of the minimum 1-tree, a spanning
+ * tree of cities 1..n-1 plus the two cheapest edges from city 0, with
+ * weighted distances d(i,j) + pi(i) + pi(j), and records each city's degree.
+********************************************************************************/
+double EXA::getOneTree(std::vector<int> &degree){
+  std::vector<double> key(size, INFINITY);              // Cheapest edge into tree
+  std::vector<int> parent(size, -1);
+  std::vector<bool> inTree(size, false);
+  degree.assign(size, 0);
+  double cost = 0;
+
+  key[1] = 0;
+  for(int added = 1; added < size; added++){            // Prim's algorithm over cities 1..n-1
+    int u = -1;
+    for(int v = 1; v < size; v++){
+      if(!inTree[v] && (u < 0 || key[v] < key[u])) u = v;
+    }
+    inTree[u] = true;
+    cost += key[u];
+    if(parent[u] >= 0){
+      degree[u]++;
+      degree[parent[u]]++;
+    }
+    for(int v = 1; v < size; v++){
+      double w = distance[u][v] + pi[u] + pi[v];
+      if(!inTree[v] && w < key[v]){
+        key[v] = w;
+        parent[v] = u;
+      }
+    }
+  }
+
+  int first = -1, second = -1;                          // Two cheapest edges from city 0
+  for(int v = 1; v < size; v++){
+    double w = distance[0][v] + pi[0] + pi[v];
+    if(first < 0 || w < distance[0][first] + pi[0] + pi[first]){
+      second = first;
+      first = v;
+    }
+    else if(second < 0 || w < distance[0][second] + pi[0] + pi[second]){
+      second = v;
+    }
+  }
+  cost += distance[0][first] + pi[0] + pi[first] + distance[0][second] + pi[0] + pi[second];
+  degree[0] = 2;
+  degree[first]++;
+  degree[second]++;
+  return cost;
+}
+
+/********************************************************************************
+ * setWeights() raises the 1-tree bound by subgradient optimization: cities of
+ * degree above 2 get heavier and leaves get lighter, with a step size that
+ * halves whenever the bound stops rising. Any weights give valid bounds; the
+ * best found are kept.
+********************************************************************************/
+void EXA::setWeights(){
+  pi.assign(size, 0);
+  std::vector<double> bestPi(pi);
+  std::vector<int> degree;
+  double bestBound = -INFINITY, step = 2;
+  int stale = 0;                                        // Iterations since bound rose
+
+  for(int i = 0; i < 50*size && step > 1e-3; i++){      // For each subgradient step
+    double weights = 0;
+    for(int v = 0; v < size; v++){
+      weights += pi[v];
+    }
+    double bound = getOneTree(degree) - 2*weights;        // Lower bound on any tour
+    if(bound > bestBound){                                // If bound rose
+      bestBound = bound;
+      bestPi = pi;
+      stale = 0;
+    }
+    else if(++stale >= size){                             // Else, if bound stopped rising
+      step /= 2;
+      stale = 0;
+    }
+    double norm = 0;
+    for(int v = 0; v < size; v++){
+      norm += (degree[v] - 2)*(degree[v] - 2);
+    }
+    if(norm == 0 || bound > bestCost - 1){                // If 1-tree is a tour, or best is proven
+      break;
+    }
+    double t = step*(bestCost - bound)/norm;
+    for(int v = 0; v < size; v++){
+      pi[v] += t*(degree[v] - 2);
+    }
+  }
+  pi = bestPi;
+}
+
+/********************************************************************************
+ * getTreeBound() bounds the cost of the rest of a tour whose path has visited
+ * the given cities and ends at a city. The rest is a path from that city
+ * through every unvisited city to city 0, so it costs at least a spanning
+ * tree of those cities under the weights, less the weights each city adds
+ * to the path: twice for an unvisited city, once for each end.
+********************************************************************************/
+double EXA::getTreeBound(int visited, int last){
+  int cities[EXACT_SIZE];
+  int count = 0;
+  double weights = pi[last] + pi[0];
+  cities[count++] = last;
+  cities[count++] = 0;
+  for(int v = 1; v < size; v++){                        // For each unvisited city
+    if(!(visited & (1 << v))){
+      cities[count++] = v;
+      weights += 2*pi[v];
+    }
+  }
+
+  double key[EXACT_SIZE];                               // Prim's algorithm over the cities
+  bool inTree[EXACT_SIZE];
+  for(int i = 0; i < count; i++){
+    key[i] = INFINITY;
+    inTree[i] = false;
+  }
+  key[0] = 0;
+  double cost = 0;
+  for(int added = 0; added < count; added++){
+    int u = -1;
+    for(int i = 0; i < count; i++){
+      if(!inTree[i] && (u < 0 || key[i] < key[u])) u = i;
+    }
+    inTree[u] = true;
+    cost += key[u];
+    int cu = cities[u];
+    for(int i = 0; i < count; i++){
+      int ci = cities[i];
+      double w = distance[cu][ci] + pi[cu] + pi[ci];
+      if(!inTree[i] && w < key[i]) key[i] = w;
+    }
+  }
+  return cost - weights;
+}
+
+/********************************************************************************
+ * branch() extends the path ending at a city, with the given cost and count
+ * of cities, by each unvisited city in order of distance, skipping any whose
+ * bound is not below the best tour. A full path closes into a tour.
+********************************************************************************/
+void EXA::branch(int last, int cost, int depth){
+  if((++nodes & 4095) == 0 && getDuration() >= stop){   // If search time is up
+    proven = false;
+  }
+  if(!proven){                                          // If search was stopped
+    return;
+  }
+  int visited = 0;
+  for(int i = 0; i < depth; i++){
+    visited |= 1 << path[i];
+  }
+  if(depth == size){                                    // If path visits every city
+    int total = cost + distance[last][0];                 // Close tour
+    if(total < bestCost){                                 // If tour is the best so far
+      bestCost = total;
+      std::copy(path.begin(), path.end(), best);
+    }
+    return;
+  }
+
+  std::vector<int> next;                                // Unvisited cities
+  for(int v = 1; v < size; v++){
+    if(!(visited & (1 << v))) next.push_back(v);
+  }
+  std::sort(next.begin(), next.end(), [this, last](int a, int b){
+    return distance[last][a] < distance[last][b];
+  });
+  for(unsigned i = 0; i < next.size(); i++){            // For each unvisited city
+    int c = next[i];
+    int extended = cost + distance[last][c];
+    if(extended >= bestCost){                             // If path already costs as much as best
+      continue;
+    }
+    double bound = extended + getTreeBound(visited | (1 << c), c);
+    if(ceil(bound - 1e-6) >= bestCost){                   // If no tour through path is better
+      continue;
+    }
+    path.push_back(c);
+    branch(c, extended, depth + 1);                       // Extend path
+    path.pop_back();
+  }
+}
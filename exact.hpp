@@ -0,0 +1,61 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The EXA class solves small problems to proven optimality.
+ *              Up to HELD_KARP_SIZE cities it runs the Held-Karp dynamic
+ *              program over subsets of cities, taking the minimum over all
+ *              last cities of a subset with vector instructions. Up to
+ *              EXACT_SIZE cities it runs a depth-first branch and bound that
+ *              extends a path from city 0, bounding the rest of the tour by a
+ *              spanning tree under Lagrangian city weights found by
+ *              subgradient optimization of the 1-tree bound. Clustered cities
+ *              give weak bounds, so branch and bound gets at most
+ *              BRANCH_SECONDS and half the time limit; if it stops unproven,
+ *              GLS searches for the rest of the time and the better tour is
+ *              kept.
+ * Sources: see main.cpp header for program sources
+ *   Held, Karp, "The traveling-salesman problem and minimum spanning trees",
+ *   Operations Research 18, 1970
+********************************************************************************/
+#ifndef EXACT_HPP
+#define EXACT_HPP
+
+#include <vector>
+#include "tsp.hpp"
+
+#define HELD_KARP_SIZE 20          // Largest problem solved by dynamic programming, a 50 MB table
+#define EXACT_SIZE 25              // Largest problem solved exactly
+#define HELD_KARP_LANES 8          // Ints compared at once; subset rows are padded to a multiple
+#define BRANCH_SECONDS 5           // Longest branch and bound search before GLS takes over
+
+class EXA: public TSP{
+  public:
+	bool proven;             // Best tour is proven optimal
+	int simd;                // Vector unit used by dynamic program: 0 scalar, 1 AVX2
+	long nodes;              // Count of subsets or search nodes visited
+	int width;               // Ints per subset in the dynamic program, one per last city, padded
+	int *table;              // Held-Karp path costs, width per subset
+	int *rows;               // Distances from each city, width per city
+	double stop;             // Time branch and bound stops at
+	std::vector<double> pi;  // Lagrangian city weights
+	std::vector<int> path;   // Path being extended by branch and bound
+
+  public:
+	EXA();                                     // Constructor
+
+	size_t getArenaSize();                     // Get bytes needed by all arrays
+	void initialize();                         // Create first tour
+	void runAlgorithm();                       // Solve and write results
+	void solve();                              // Solve problem exactly
+	void solveHeldKarp();                      // Solve by dynamic programming
+	int getRowMin(const int*, const int*);     // Minimum of sums of two rows
+	int getRowMinAVX2(const int*, const int*); // Minimum of sums of two rows, AVX2
+	void solveBranchAndBound();                // Solve by branch and bound
+	void searchRest();                         // Search by GLS for the rest of the time
+	void setUpperBound();                      // Improve first tour by 2-opt
+	void setWeights();                         // Find Lagrangian weights of 1-tree bound
+	double getOneTree(std::vector<int>&);      // Weighted 1-tree cost and city degrees
+	double getTreeBound(int, int);             // Bound on rest of tour after a path
+	void branch(int, int, int);                // Extend path by each unvisited city
+};
+#endif
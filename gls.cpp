@@ -6,7 +6,16 @@
  *              of class functions.
  * Sources: see main.cpp header for program sources
 ********************************************************************************/
+#include <algorithm>
+#include <immintrin.h>
+#include <thread>
 #include "gls.hpp"
+#include "trace.hpp"
+
+#define SIMD_MAX_SIZE 46340   // Largest size whose edge store can be indexed by 32-bit gathers
+#define MIN_SEGMENT_SIZE 50   // Shortest tour segment searched on its own thread
+#define SEGMENT_NEIGHBORS 10  // Nearest cities tried by segment local search
+#define FIXED_COST (1 << 28)  // Negative augmented cost of a fixed edge, so removing one never pays
 
 /********************************************************************************
  * Constructor initializes driving variables.
@@ -16,19 +25,40 @@ GLS::GLS(){
   setFlsIterations(20);      // Initialize FLS iterations to 20
   lambda = 0;                // Initialize lambda to 0
   costChange = 0;            // Initialize costChange to 0
-  penaltyChange = 0;         // Initialize penaltyChange to 0
+  active = NULL;             // Initialize to searching every city
+  segments = 1;              // Initialize to sequential local search
+  nearest = home = NULL;     // Initialize segment arrays to empty
+  partner = NULL;            // Initialize to no fixed edges
+  trace = NULL;              // Initialize to no trace
+
+  simd = 0;                                  // Initialize to scalar neighbor scans
+  if(__builtin_cpu_supports("avx512f")){     // If CPU has AVX-512
+    simd = 2;                                  // Scan 16 neighbors at once
+  }
+  else if(__builtin_cpu_supports("avx2")){   // Else, if CPU has AVX2
+    simd = 1;                                  // Scan 8 neighbors at once
+  }
 }
 
 /********************************************************************************
- * Deconstructor
+ * Deconstructor. GLS arrays live in the TSP arena, which frees them.
 ********************************************************************************/
 GLS::~GLS(){
-  delete [] utility;                 // Delete utilities
-  delete [] bit;                     // Delete bits
-  for(int i = 0; i < size; i++){     // For each city
-	  delete [] penalty[i];            // Delete edge penalty
-  }
-  delete [] penalty;                 // Delete penalties
+}
+
+/********************************************************************************
+ * getArenaSize() adds the bytes of the positions, penalty bits and augmented
+ * costs to the TSP class's arrays. Penalties are sparse and are kept in a
+ * map outside the arena.
+********************************************************************************/
+size_t GLS::getArenaSize(){
+  return TSP::getArenaSize() +
+         Arena::align(size*sizeof(int)) +                 // Positions
+         Arena::align(size*sizeof(bool)) +                // Penalty bits
+         Arena::align(size*sizeof(int*)) +                // Augmented cost rows
+         Arena::align((size_t)size*size*sizeof(int)) +    // Augmented costs
+         (segments > 1 ? Arena::align((size_t)size*SEGMENT_NEIGHBORS*sizeof(int)) +   // Nearest cities
+                         Arena::align(size*sizeof(int)) : 0);                          // Cities' segments
 }
 
 /********************************************************************************
@@ -45,20 +75,87 @@ void GLS::setFlsIterations(int limit){
   maxFLS = limit;
 };
 
+/********************************************************************************
+ * setSegments() initializes the count of tour segments searched in parallel
+ * for the first local optimum to programmer's input.
+********************************************************************************/
+void GLS::setSegments(int count){
+  segments = max(count, 1);
+}
+
+/********************************************************************************
+ * setPartners() sets the fixed edges, given as the city at the other end of
+ * each city's fixed edge, or -1. Every fixed edge must be in the starting
+ * tour. Must be called before initialize().
+********************************************************************************/
+void GLS::setPartners(int *cities){
+  partner = cities;
+}
+
 /********************************************************************************
  * setLambda() calculates lambda variable based on values of alpha, problem
- * size, and current best tour cost.
+ * size, and current best tour cost. If lambda changes, the augmented cost of
+ * every penalized edge is recalculated; unpenalized edges are unaffected.
 ********************************************************************************/
 void GLS::setLambda(){
+  int previous = lambda;                                  // Hold previous lambda
   lambda = round((alpha*(double)(bestCost/size)));
+  if(lambda != previous){                                 // If lambda has changed
+    for(auto &entry : penalties){                           // For each penalized edge
+      setAugmentedCost(entry.first / size, entry.first % size);   // Recalculate its augmented cost
+    }
+  }
 };
 
+/********************************************************************************
+ * setAugmentedCost() recalculates the augmented cost of the edge between two
+ * cities in both directions from its distance, penalty and lambda.
+********************************************************************************/
+void GLS::setAugmentedCost(int c1, int c2){
+  augmented[c1][c2] = distance[c1][c2] + lambda*getPenalty(c1, c2);
+  augmented[c2][c1] = augmented[c1][c2];
+}
+
+/********************************************************************************
+ * getEdgeKey() returns the key of the edge between two cities in the penalty
+ * map, the same in both directions.
+********************************************************************************/
+long long GLS::getEdgeKey(int c1, int c2){
+  return (long long)min(c1, c2)*size + max(c1, c2);
+}
+
+/********************************************************************************
+ * getPenalty() returns the penalty of the edge between two cities, 0 if it
+ * has never been penalized.
+********************************************************************************/
+int GLS::getPenalty(int c1, int c2){
+  auto found = penalties.find(getEdgeKey(c1, c2));
+  return found == penalties.end() ? 0 : found->second;
+}
+
 /********************************************************************************
  * initialize() creates dynamic arrays for GLS's utility and penalty features.
 ********************************************************************************/
 void GLS::initialize(){
-  TSP::initialize();                     // Call TSP class initializing function
+  if(segments > 1){                      // If parallel search was requested
+    setHilbertTour(tour);                  // Start from a tour whose segments are compact regions
+    tourCost = getTourCost(tour);          // Get the cost of the tour
+    setBest();                             // Set the best tour as current tour
+  }
+  else{                                  // Else
+    TSP::initialize();                     // Call TSP class initializing function
+  }
+  initializeSearch();                    // Call function to create GLS arrays
+  if(segments > 1){                      // If parallel search was requested
+    parallelLocalSearch();                 // Descend to first local optimum in parallel
+  }
+}
 
+/********************************************************************************
+ * initializeSearch() sets alpha for the problem size and creates the GLS
+ * arrays for the current tour, which must already be set.
+********************************************************************************/
+void GLS::initializeSearch(){
   if(size < 500){                        // If problem size is < 500
 	  setAlpha(0.167);                     // Set alpha to 0.167
   }
@@ -72,82 +169,197 @@ void GLS::initialize(){
 	  setAlpha(0.5);                       // Set alpha to maximum, 0.5
   }
 
-  utility = new int[size];               // Create dynamic array for utilities
-  bit = new bool[size];                  // Create dynamic array for penalty bits
-  penalty = new int*[size];              // Create dynamic matrix for edge penalties
-  for(int i = 0; i < size; i++){         // For each city in the tour
-    penalty[i] = new int[size];            // Create second dimension edge penalty
+  pos = arena.allocate<int>(size);       // Create dynamic array for tour positions
+  for(int i = 0; i < size; i++){         // For each place in the tour
+    pos[tour[i]] = i;                      // Record city's position
+  }
+  bit = arena.allocate<bool>(size);      // Create dynamic array for penalty bits
+  augmented = arena.allocate<int*>(size);   // Create row pointers for augmented costs
+  augmented[0] = arena.allocate<int>((size_t)size*size);   // Create augmented costs as one contiguous block
+  for(int i = 1; i < size; i++){         // For each remaining city in the tour
+    augmented[i] = augmented[0] + (long)i*size;   // Point to city's row of the block
   }
 
   setPenalties();                        // Call function to initialize edge penalty values
 }
 
+/********************************************************************************
+ * setStartTour() replaces the current tour with the given tour, keeping the
+ * edge penalties, and sets every city's penalty bit so the next FLS visits
+ * the whole tour. The given tour becomes the best tour if it is better.
+********************************************************************************/
+void GLS::setStartTour(const int *cities){
+  for(int i = 0; i < size; i++){         // For each place in the tour
+    tour[i] = cities[i];                   // Copy city
+    pos[tour[i]] = i;                      // Record city's position
+    bit[i] = true;                         // Set penalty bit to true
+  }
+  tourCost = getTourCost(tour);          // Get the cost of the tour
+  if(tourCost < bestCost){               // If the tour is better than the best tour
+    setBest();                             // Set it as the best tour
+  }
+  setUtilities();                        // Rebuild utility heap for new tour
+}
+
+/********************************************************************************
+ * takePendingTour() takes the Christofides tour built in the background, if
+ * it has finished, as the current tour when it is better than the best
+ * tour found so far. Checked before each fast local search.
+********************************************************************************/
+void GLS::takePendingTour(){
+  if(!pending.valid() ||                                        // If no tour is being built,
+     pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready){   // or it is not finished
+    return;
+  }
+  std::vector<int> path = pending.get();                        // Take finished tour
+  if(getTourCost(path.data()) < bestCost){                      // If it is better than the best tour
+    setStartTour(path.data());                                    // Continue search from it
+  }
+}
+
 /********************************************************************************
  * setPenalties() reinitializes city penalty bits and edge penalty values
- * for new run of GLS algorithm.
+ * for new run of GLS algorithm, then rebuilds the utility heap. An object
+ * owning its distances fills the edge store's rows on several threads; one
+ * sharing them fills its rows alone, since it already runs on the thread
+ * that searches them.
 ********************************************************************************/
 void GLS::setPenalties(){
-  for(int i = 0; i < size; i++) {     // For each city
-    bit[i] = true;                      // Set penalty bit to true
-    for(int j = 0; j < size; j++)       // For possible edge with city
-      penalty[i][j] = 0;                    // Set penalty to 0
+  if(trace && !trace->log(TRACE_RESET, 0)){   // If a replay has diverged
+    maxGLS = 0;                                 // Stop search
+  }
+  auto fill = [this](int first, int last){
+    for(int i = first; i < last; i++) {   // For each city
+      bit[i] = true;                        // Set penalty bit to true
+      for(int j = 0; j < size; j++){        // For possible edge with city
+        augmented[i][j] = distance[i][j];     // Set augmented cost to distance
+      }
+      if(partner && partner[i] >= 0){       // If city has a fixed edge
+        augmented[i][partner[i]] = -FIXED_COST;   // Make removing it cost more than any gain
+      }
+    }
+  };
+  if(shared){                         // If object shares its distances
+    fill(0, size);                      // Fill every row on this thread
   }
+  else{                               // Else
+    forRows(size, fill, rowThreads);    // Fill blocks of rows in parallel
+  }
+  penalties.clear();                  // No edges are penalized
+  setUtilities();                     // Rebuild utility heap with zero penalties
 }
 
 /********************************************************************************
- * updatePenalties() calls function to calculate lambda, calculates and
- * assigns the maximum utility to the highest cost edges, then updates
- * subsequent edge penalty values and corresponding city penalty bits.
+ * setUtilities() discards every heap entry and pushes the utility of each
+ * edge in the current tour.
+********************************************************************************/
+void GLS::setUtilities(){
+  std::vector<Utility> entries;                   // Holds one entry per tour edge
+  entries.reserve(size);                          // Reserve space for all tour edges
+  for(int i = 0; i < size; i++){                  // For each city
+    int c1 = tour[i];                               // Get city
+    int c2 = tour[getNext(i)];                      // Get city's next neighbor
+    if((!isActive(c1) && !isActive(c2)) || isFixed(c1, c2)){   // If edge is outside the searched region or fixed
+      continue;                                       // Never penalize it
+    }
+    Utility entry = {distance[c1][c2], getPenalty(c1, c2), c1, c2};
+    entries.push_back(entry);                       // Add edge's utility
+  }
+  utility = std::priority_queue<Utility>(std::less<Utility>(), entries);   // Heapify entries in O(n)
+}
+
+/********************************************************************************
+ * pushUtility() pushes the utility of the edge between two cities, using the
+ * edge's current distance and penalty. If stale entries dominate the heap,
+ * it is rebuilt from the current tour instead.
+********************************************************************************/
+void GLS::pushUtility(int c1, int c2){
+  if(utility.size() > (unsigned)(4*size)){   // If stale entries dominate the heap
+    setUtilities();                            // Rebuild heap from current tour
+    return;
+  }
+  if((!isActive(c1) && !isActive(c2)) || isFixed(c1, c2)){   // If edge is outside the searched region or fixed
+    return;                                    // Never penalize it
+  }
+  Utility entry = {distance[c1][c2], getPenalty(c1, c2), c1, c2};
+  utility.push(entry);
+}
+
+/********************************************************************************
+ * isActive() returns whether or not a city is in the searched region. Every
+ * city is, unless an active array limits the search.
+********************************************************************************/
+bool GLS::isActive(int city){
+  return !active || active[city];
+}
+
+/********************************************************************************
+ * isFixed() returns whether or not the edge between two cities is fixed.
+********************************************************************************/
+bool GLS::isFixed(int c1, int c2){
+  return partner && partner[c1] == c2;
+}
+
+/********************************************************************************
+ * isTourEdge() returns whether or not two cities are neighbors in the
+ * current tour.
+********************************************************************************/
+bool GLS::isTourEdge(int c1, int c2){
+  return (tour[getNext(pos[c1])] == c2) || (tour[getNext(pos[c2])] == c1);
+}
+
+/********************************************************************************
+ * updatePenalties() calls function to calculate lambda, pops the maximum
+ * utility edges off the utility heap, then updates their edge penalty values
+ * and corresponding city penalty bits. Heap entries for edges that have left
+ * the tour, or whose penalty has since changed, are discarded as they are
+ * popped, so only edges changed by swaps and penalties are ever pushed.
 ********************************************************************************/
 void GLS::updatePenalties(){
-  double current;                                              // Current calculated utility
-  double max = 0;                                              // Max calculated utility
-  int count = 0;                                               // Count of max utility cities
+  std::vector<Utility> maxEdges;                               // Max utility edges penalized this iteration
 
   setLambda();                                                 // Call function to set lambda
 
-  for(int i = 0; i < size; i++){                               // For each city
-     current = (double)(distance[tour[i]][tour[getNext(i)]])/    // Calculate utility of edge between city and next neighbor
-    	    (double)(1 + penalty[tour[i]][tour[getNext(i)]]);
-     if(current > max){                                          // If the city's utility is greater than the max utility found
-       utility[0] = i;                                             // Add city to list of max utilities
-       max = current;                                              // Assign as max utility
-       count = 1;                                                  // Reset count of max utility cities
-     }
-     else if(current == max) {                                   // If city's utility matches the max utility found
-       utility[count] = i;                                         // Add city to list of max utilities
-       count++;                                                    // Increment count of max utility cities
-     }
-   }
-
-  int c1, c2;
-  for(int i = 0; i < count; i++){                              // For each max utility city
-     c1 = tour[utility[i]];                                      // Get city's place in the current tour
-     c2 = tour[getNext(utility[i])];                             // Get city's edge neighbor
-     penalty[c1][c2]++;                                          // Increment penalty of edge
-     penalty[c2][c1]++;                                          // Increment penalty of corresponding edge
-     bit[c1] = bit[c2] = true;                                   // Set city's and neighbor's penalty bit to true
-   }
+  while(!utility.empty()){                                     // While there are heap entries
+    Utility top = utility.top();                                 // Get max utility entry
+    if(!maxEdges.empty() && top < maxEdges[0]){                 // If this entry's utility is lower than the max utility found
+      break;                                                       // All max utility edges have been found
+    }
+    utility.pop();                                               // Remove entry from heap
+    if(getPenalty(top.c1, top.c2) != top.penalty ||              // If edge's penalty has changed
+       !isTourEdge(top.c1, top.c2)){                             // Or edge is no longer in the tour
+      continue;                                                    // Discard stale entry
+    }
+    penalties[getEdgeKey(top.c1, top.c2)]++;                     // Increment penalty of edge in both directions
+    setAugmentedCost(top.c1, top.c2);                            // Update augmented cost of edge
+    if(trace && !trace->log(TRACE_PENALTY - top.c1, top.c2)){   // If a replay has diverged
+      maxGLS = 0;                                                  // Stop search
+    }
+    bit[top.c1] = bit[top.c2] = true;                            // Set city's and neighbor's penalty bit to true
+    maxEdges.push_back(top);                                     // Record max utility edge
+  }
+
+  for(unsigned i = 0; i < maxEdges.size(); i++){               // For each penalized edge
+    pushUtility(maxEdges[i].c1, maxEdges[i].c2);                 // Push its new utility
+  }
 }
 
 /********************************************************************************
- * getSwapCost() calculates and returns the total distance and resulting penalty
- * costs of a potential edge swap.
+ * getSwapCost() calculates and returns the change in augmented cost, distance
+ * plus penalty, of a potential edge swap. When the swap is beneficial, its
+ * change in distance alone is recorded in costChange.
 ********************************************************************************/
 int GLS::getSwapCost(int c1,int c2){
-  int c1n2 = getNext(c1);               // Get city1's next neighbor
-  int c2n2 = getNext(c2);               // Get city2's next neighbor
-
-  // Calculate distance change of swapping edges
-  costChange = distance[tour[c1]][tour[c2]] + distance[tour[c1n2]][tour[c2n2]] -
-	           distance[tour[c1]][tour[c1n2]] - distance[tour[c2]][tour[c2n2]];
+  int a = tour[c1], b = tour[c2];                        // City1 and city2
+  int an = tour[getNext(c1)], bn = tour[getNext(c2)];    // Their next neighbors
 
-  // Calculate penalty of swapping edges
-  penaltyChange = (penalty[tour[c1]][tour[c2]] + penalty[tour[c1n2]][tour[c2n2]] -
-				   penalty[tour[c1]][tour[c1n2]] - penalty[tour[c2]][tour[c2n2]])*lambda;
+  // Calculate augmented cost of adding edges a-b and an-bn and removing a-an and b-bn
+  int swapCost = augmented[a][b] + augmented[an][bn] - augmented[a][an] - augmented[b][bn];
 
-  // Return sum of cost and penalty changes
-  return costChange + penaltyChange;
+  if(swapCost < 0){                                      // If swap is beneficial
+    costChange = distance[a][b] + distance[an][bn] - distance[a][an] - distance[b][bn];
+  }
+  return swapCost;
 }
 
 /********************************************************************************
@@ -155,6 +367,9 @@ int GLS::getSwapCost(int c1,int c2){
  * neighbor passed into the function.
 ********************************************************************************/
 void GLS::twoOptSwap(int city, int neighbor, int *tour){
+  if(trace && !trace->log(city, neighbor)){ // If a replay has diverged
+    maxGLS = 0;                               // Stop search
+  }
   int c1 = min(city, neighbor);             // Get earliest city
   int c2 = max(city, neighbor);             // Get latest city
   int rightNeighbor = getNext(c1);          // Get right neighbor of earliest city
@@ -171,6 +386,8 @@ void GLS::twoOptSwap(int city, int neighbor, int *tour){
 
     temp1 = tour[rightNeighbor];	          // Hold right neighbor
     temp2 = tour[leftNeighbor];               // Hold left neighbor
+    pos[temp1] = leftNeighbor;                // Record right neighbor's new position
+    pos[temp2] = rightNeighbor;               // Record left neighbor's new position
     tour[leftNeighbor--] = temp1;             // Swap left neighbor with right neighbor, go to next left neighbor
     tour[rightNeighbor++] = temp2;            // Swap right neighbor with left neighbor, got to next right neighbor
   }
@@ -194,6 +411,8 @@ bool GLS::twoOPT(int c1,int c2){
   	bit[tour[c2]] = 1;               // Set city2's penalty bit to true
   	bit[tour[c2n2]]= 1;              // Set city2's next neighbor's bit to true
   	twoOptSwap(c1n1, c2, tour);      // Swap city2 with city1's previous neighbor
+  	pushUtility(tour[c1n1], tour[c1]);   // Push utilities of the two added edges
+  	pushUtility(tour[c2], tour[c2n2]);
 	tourCost += costChange;          // Add costChange to the total tourCost
 	if(bestCost > tourCost){         // If the tour cost is less than the current best tour cost
 	  setBest();                       // Set the best tour cost to the current tour cost
@@ -207,6 +426,8 @@ bool GLS::twoOPT(int c1,int c2){
   	bit[tour[c2]] = 1;               // Set city2's penalty bit to true
   	bit[tour[c2n2]]=1;               // Set city2's next neighbor's bit to true
   	twoOptSwap(c1,c2, tour);         // Swap city1 with city2
+  	pushUtility(tour[c1], tour[c1n2]);   // Push utilities of the two added edges
+  	pushUtility(tour[c2], tour[c2n2]);
 	tourCost += costChange;          // Add cost gain to total tour cost
 	if(bestCost > tourCost){         // If the tour cost is less than the current best tour
 	  setBest();                       // Set the best tour cost to the current tour cost
@@ -220,6 +441,8 @@ bool GLS::twoOPT(int c1,int c2){
     bit[tour[c2]] = 1;               // Set city2's penalty bit to true
     bit[tour[c1n2]]= 1;              // Set city1's next neighbor's bit to true
     twoOptSwap(c2n1, c1, tour);      // Swap city1 with city2's previous neighbor
+    pushUtility(tour[c2n1], tour[c2]);   // Push utilities of the two added edges
+    pushUtility(tour[c1], tour[c1n2]);
   	tourCost += costChange;          // Add costChange to the total tourCost
   	if(bestCost > tourCost){         // If the tour cost is less than the current best tour cost
   	  setBest();                       // Set the best tour cost to the current tour cost
@@ -230,6 +453,135 @@ bool GLS::twoOPT(int c1,int c2){
   return false;                    // Else, return that beneficial swap was not found
 }
 
+/********************************************************************************
+ * hasSwap() returns whether or not any of the three swaps twoOPT() tries
+ * for a city and a neighbor is beneficial, without making it.
+********************************************************************************/
+bool GLS::hasSwap(int c1, int c2){
+  return getSwapCost(getPrev(c1), c2) < 0 ||    // Swapping city1's previous neighbor with city2
+         getSwapCost(c1, c2) < 0 ||             // Swapping city1 with city2
+         getSwapCost(getPrev(c2), c1) < 0;      // Swapping city2's previous neighbor with city1
+}
+
+/********************************************************************************
+ * findSwap() returns the first tour position at or after from, other than
+ * the city and its two neighbors, with a beneficial swap for the city, or
+ * size if there is none. Positions away from the ends of the tour are
+ * checked in batches with AVX-512 or AVX2 when the CPU has them, and one at
+ * a time otherwise.
+********************************************************************************/
+int GLS::findSwap(int city, int from){
+  int width = (size > SIMD_MAX_SIZE) ? 0 :           // Count of neighbors checked at once
+              (simd == 2) ? 16 : (simd == 1) ? 8 : 0;
+  int neighbor = from;                               // Tour position to check
+
+  while(neighbor < size){                            // While there are neighbors left
+    if(width && neighbor >= 1 && neighbor + width < size){   // If a whole batch fits between the tour's ends
+      int found = (width == 16) ? findSwapAVX512(city, neighbor) :
+                                  findSwapAVX2(city, neighbor);
+      if(found >= 0){                                  // If batch holds a beneficial swap
+        return found;                                    // Return its position
+      }
+      neighbor += width;                               // Go to next batch
+    }
+    else{                                            // Else, check neighbor alone
+      if(neighbor != city &&                           // If neighbor is not the city
+         neighbor != getNext(city) &&                  // Or the neighbor just after the city
+         neighbor != getPrev(city) &&                  // Or the neighbor just before the city
+         hasSwap(city, neighbor)){                     // And a swap with it is beneficial
+        return neighbor;                                 // Return its position
+      }
+      neighbor++;                                      // Go to next neighbor
+    }
+  }
+  return size;                                       // No beneficial swap was found
+}
+
+/********************************************************************************
+ * findSwapAVX2() computes the augmented cost of the three swaps twoOPT()
+ * tries for a city and each of the 8 neighbors starting at tour position
+ * first, gathering the edge costs from the edge store. Returns the first
+ * neighbor with a beneficial swap, or -1 if there is none.
+********************************************************************************/
+__attribute__((target("avx2")))
+int GLS::findSwapAVX2(int city, int first){
+  const int *store = augmented[0];                                      // Augmented costs
+  int a = tour[getPrev(city)], b = tour[city], c = tour[getNext(city)];   // City and its neighbors
+  __m256i vn = _mm256_set1_epi32(size);
+
+  __m256i p = _mm256_loadu_si256((const __m256i*)(tour + first - 1));   // Neighbors' previous cities
+  __m256i q = _mm256_loadu_si256((const __m256i*)(tour + first));       // Neighbors
+  __m256i r = _mm256_loadu_si256((const __m256i*)(tour + first + 1));   // Neighbors' next cities
+
+  __m256i aq = _mm256_i32gather_epi32(augmented[a], q, 4);              // Edges from city's previous neighbor
+  __m256i br = _mm256_i32gather_epi32(augmented[b], r, 4);              // Edges from city
+  __m256i bq = _mm256_i32gather_epi32(augmented[b], q, 4);
+  __m256i bp = _mm256_i32gather_epi32(augmented[b], p, 4);
+  __m256i cr = _mm256_i32gather_epi32(augmented[c], r, 4);              // Edges from city's next neighbor
+  __m256i cq = _mm256_i32gather_epi32(augmented[c], q, 4);
+  __m256i qr = _mm256_i32gather_epi32(store,                            // Tour edges after neighbors
+               _mm256_add_epi32(_mm256_mullo_epi32(q, vn), r), 4);
+  __m256i pq = _mm256_i32gather_epi32(store,                            // Tour edges before neighbors
+               _mm256_add_epi32(_mm256_mullo_epi32(p, vn), q), 4);
+  __m256i ab = _mm256_set1_epi32(augmented[a][b]);                      // Tour edges at city
+  __m256i bc = _mm256_set1_epi32(augmented[b][c]);
+
+  __m256i swap1 = _mm256_sub_epi32(_mm256_add_epi32(aq, br), _mm256_add_epi32(ab, qr));
+  __m256i swap2 = _mm256_sub_epi32(_mm256_add_epi32(bq, cr), _mm256_add_epi32(bc, qr));
+  __m256i swap3 = _mm256_sub_epi32(_mm256_add_epi32(bp, cq), _mm256_add_epi32(pq, bc));
+  __m256i least = _mm256_min_epi32(swap1, _mm256_min_epi32(swap2, swap3));
+  int mask = _mm256_movemask_ps(_mm256_castsi256_ps(least));            // Lanes with a negative cost
+
+  for(int skip = -1; skip <= 1; skip++){                               // For the city and its neighbors
+    int lane = (city + skip + size) % size - first;
+    if(lane >= 0 && lane < 8){                                           // If it is in the batch
+      mask &= ~(1 << lane);                                                // Do not swap with it
+    }
+  }
+  return mask ? first + __builtin_ctz(mask) : -1;
+}
+
+/********************************************************************************
+ * findSwapAVX512() is findSwapAVX2() for 16 neighbors at once.
+********************************************************************************/
+__attribute__((target("avx512f")))
+int GLS::findSwapAVX512(int city, int first){
+  const int *store = augmented[0];                                      // Augmented costs
+  int a = tour[getPrev(city)], b = tour[city], c = tour[getNext(city)];   // City and its neighbors
+  __m512i vn = _mm512_set1_epi32(size);
+
+  __m512i p = _mm512_loadu_si512(tour + first - 1);                     // Neighbors' previous cities
+  __m512i q = _mm512_loadu_si512(tour + first);                         // Neighbors
+  __m512i r = _mm512_loadu_si512(tour + first + 1);                     // Neighbors' next cities
+
+  __m512i aq = _mm512_i32gather_epi32(q, augmented[a], 4);              // Edges from city's previous neighbor
+  __m512i br = _mm512_i32gather_epi32(r, augmented[b], 4);              // Edges from city
+  __m512i bq = _mm512_i32gather_epi32(q, augmented[b], 4);
+  __m512i bp = _mm512_i32gather_epi32(p, augmented[b], 4);
+  __m512i cr = _mm512_i32gather_epi32(r, augmented[c], 4);              // Edges from city's next neighbor
+  __m512i cq = _mm512_i32gather_epi32(q, augmented[c], 4);
+  __m512i qr = _mm512_i32gather_epi32(                                  // Tour edges after neighbors
+               _mm512_add_epi32(_mm512_mullo_epi32(q, vn), r), store, 4);
+  __m512i pq = _mm512_i32gather_epi32(                                  // Tour edges before neighbors
+               _mm512_add_epi32(_mm512_mullo_epi32(p, vn), q), store, 4);
+  __m512i ab = _mm512_set1_epi32(augmented[a][b]);                      // Tour edges at city
+  __m512i bc = _mm512_set1_epi32(augmented[b][c]);
+
+  __m512i swap1 = _mm512_sub_epi32(_mm512_add_epi32(aq, br), _mm512_add_epi32(ab, qr));
+  __m512i swap2 = _mm512_sub_epi32(_mm512_add_epi32(bq, cr), _mm512_add_epi32(bc, qr));
+  __m512i swap3 = _mm512_sub_epi32(_mm512_add_epi32(bp, cq), _mm512_add_epi32(pq, bc));
+  __m512i least = _mm512_min_epi32(swap1, _mm512_min_epi32(swap2, swap3));
+  int mask = _mm512_cmplt_epi32_mask(least, _mm512_setzero_si512());   // Lanes with a negative cost
+
+  for(int skip = -1; skip <= 1; skip++){                               // For the city and its neighbors
+    int lane = (city + skip + size) % size - first;
+    if(lane >= 0 && lane < 16){                                          // If it is in the batch
+      mask &= ~(1 << lane);                                                // Do not swap with it
+    }
+  }
+  return mask ? first + __builtin_ctz(mask) : -1;
+}
+
 /********************************************************************************
  * fastLocalSearch() runs through a programmer defined number of iterations
  * for a current tour, finding cities that have been penalized by the GLS
@@ -240,18 +592,18 @@ void GLS::fastLocalSearch(){
   int count = 0;                                        // Count of neighbors visited
   int city = 0;                                         // Tour index
 
+  takePendingTour();                                    // Take background Christofides tour if it is better
+
   while(count < size && !hasReachedLimit()){            // While we haven't visited all the city's neighbors, and max time hasn't been met
     bool improved = false;                                // Track if swap was made
-    if(bit[tour[city]]){                                  // If the penalty bit for the current node is set to true
-      int neighbor = 0;                                     // Initialize neighbor city to first city in tour
+    if(bit[tour[city]] && isActive(tour[city])){          // If the penalty bit for the current node is set to true, and it is searched
+      int neighbor = findSwap(city, 0);                     // Find first neighbor with a beneficial swap
 
       while((neighbor < size) && (!improved)){              // While there is a neighbor left to check and no beneficial swap has been found
-	    if(neighbor != city &&                                // If neighbor is not the city
-	       neighbor != getNext(city) &&                       // Or the neighbor just before the city
-		   neighbor != getPrev(city)){                        // Or the neighbor just after the city
-	      improved = twoOPT(city, neighbor);                    // Call function to make edge swap if beneficial
+	    improved = twoOPT(city, neighbor);                    // Call function to make edge swap if beneficial
+	    if(!improved){                                        // If swap was not made
+	      neighbor = findSwap(city, neighbor + 1);              // Find next neighbor with a beneficial swap
 	    }
-	    neighbor++;                                           // Go to next neighbor in the tour
 	  }
     }
 	
@@ -267,22 +619,176 @@ void GLS::fastLocalSearch(){
   }
 }	
 
+/********************************************************************************
+ * parallelLocalSearch() splits the tour into contiguous segments and runs
+ * 2-opt inside each segment on its own thread. A move inside a segment only
+ * reverses part of the segment and only changes edges inside it, so threads
+ * never touch the same tour places, positions or bits. After each round the
+ * tour is rotated by half a segment, so the next round searches across the
+ * old boundaries. The tour should be spatially coherent, as a Hilbert curve
+ * tour is, so a segment holds most of its cities' nearest cities. Rounds go
+ * on until two rounds in a row find nothing. Every penalty bit is then
+ * cleared, so GLS starts from the local optimum instead of scanning the
+ * whole tour again, and the utility heap is rebuilt for the new tour. Only
+ * used while penalties are zero, when augmented costs are distances.
+********************************************************************************/
+void GLS::parallelLocalSearch(){
+  int length = size / segments;                         // Cities per segment
+  if(length < MIN_SEGMENT_SIZE){                        // If segments are too short to search
+    return;
+  }
+  int count = min(SEGMENT_NEIGHBORS, size - 1);         // Candidates per city
+  nearest = arena.allocate<int>((size_t)size*SEGMENT_NEIGHBORS);
+  home = arena.allocate<int>(size);
+
+  std::vector<std::thread> pool;
+  for(int k = 0; k < segments; k++){                    // For each share of cities
+    pool.push_back(std::thread([this, k, count](){
+      std::vector<int> order(size);
+      for(int c = k; c < size; c += segments){              // For each city of share
+        for(int i = 0; i < size; i++){
+          order[i] = i;
+        }
+        std::partial_sort(order.begin(), order.begin() + count + 1, order.end(),
+                          [this, c](int a, int b){ return distance[c][a] < distance[c][b]; });
+        int found = 0;
+        for(int i = 0; i <= count && found < count; i++){   // Record nearest cities but itself
+          if(order[i] != c){
+            nearest[(size_t)c*SEGMENT_NEIGHBORS + found++] = order[i];
+          }
+        }
+      }
+    }));
+  }
+  for(int k = 0; k < segments; k++){
+    pool[k].join();                                       // Wait for candidate lists
+  }
+
+  for(int i = 0; i < size; i++){                        // For each city
+    bit[i] = true;                                        // Visit it in first round
+  }
+  int stale = 0;                                        // Rounds in a row without improvement
+  while(stale < 2 && !hasReachedLimit()){               // While a recent round improved the tour
+    for(int k = 0; k < segments; k++){                    // For each segment
+      int last = (k == segments - 1) ? size : (k + 1)*length;   // Last segment takes the rest
+      for(int i = k*length; i < last; i++){
+        home[tour[i]] = k;                                  // Record city's segment
+      }
+    }
+
+    std::vector<int> change(segments, 0);                 // Cost change of each segment
+    pool.clear();
+    for(int k = 0; k < segments; k++){                    // For each segment
+      int first = k*length;
+      int last = (k == segments - 1) ? size : first + length;
+      pool.push_back(std::thread([this, &change, k, first, last](){
+        change[k] = segmentLocalSearch(first, last);
+      }));
+    }
+    int total = 0;                                        // Cost change of round
+    for(int k = 0; k < segments; k++){
+      pool[k].join();                                       // Wait for segment
+      total += change[k];
+    }
+    tourCost += total;
+    stale = (total < 0) ? 0 : stale + 1;
+
+    std::rotate(tour, tour + length/2, tour + size);      // Move boundaries by half a segment
+    for(int i = 0; i < size; i++){
+      pos[tour[i]] = i;                                     // Record cities' new positions
+      bit[tour[i]] = true;                                  // Visit it against new neighbors
+    }
+  }
+
+  for(int i = 0; i < size; i++){                        // For each city
+    bit[i] = false;                                       // Tour is a local optimum around it
+  }
+  if(tourCost < bestCost){                              // If the tour is the best tour
+    setBest();                                            // Set it as the best tour
+  }
+  setUtilities();                                       // Rebuild utility heap for new tour
+}
+
+/********************************************************************************
+ * segmentLocalSearch() runs 2-opt with penalty bits on the tour places from
+ * first up to last. For each city with its bit set, each of its two tour
+ * edges is tried against the edge at each of its nearest cities that lies
+ * in the same segment, stopping once a nearer city is no nearer than the
+ * tour neighbor, and the first swap lowering the augmented cost is made.
+ * Repeats until no bit is set. Returns the change in tour cost.
+********************************************************************************/
+int GLS::segmentLocalSearch(int first, int last){
+  int change = 0;                                       // Change in tour cost
+  int segment = home[tour[first]];                      // Segment's index
+  bool improved = true;
+  while(improved){                                      // While a swap was made
+    improved = false;
+    for(int p = first; p < last; p++){                    // For each place in segment
+      int c1 = tour[p];
+      if(!bit[c1]){                                         // If city's bit is clear
+        continue;
+      }
+      bool swapped = false;
+      for(int step = 1; step >= -1 && !swapped; step -= 2){   // For edge after, then before city
+        int p2 = p + step;
+        if(p2 < first || p2 >= last){                         // If edge leaves segment
+          continue;
+        }
+        int c2 = tour[p2];
+        int d12 = augmented[c1][c2];
+        for(int k = 0; k < SEGMENT_NEIGHBORS && !swapped; k++){   // For each nearest city
+          int c3 = nearest[(size_t)c1*SEGMENT_NEIGHBORS + k];
+          if(d12 <= augmented[c1][c3]){                    // If no nearer than tour neighbor
+            break;                                                // No later city helps
+          }
+          if(home[c3] != segment){                              // If city is in another segment
+            continue;
+          }
+          int p3 = pos[c3], p4 = p3 + step;
+          if(p4 < first || p4 >= last){                         // If its edge leaves segment
+            continue;
+          }
+          int c4 = tour[p4];
+          int gain = augmented[c1][c3] + augmented[c2][c4] - d12 - augmented[c3][c4];
+          if(gain < 0){                                         // If swap is beneficial
+            change += distance[c1][c3] + distance[c2][c4] - distance[c1][c2] - distance[c3][c4];
+            int i = min(p, p3) - (step < 0), j = max(p, p3) - (step < 0);   // Edges (i, i+1) and (j, j+1)
+            std::reverse(tour + i + 1, tour + j + 1);             // Reverse path between edges
+            for(int q = i + 1; q <= j; q++){
+              pos[tour[q]] = q;                                     // Record new positions
+            }
+            bit[c1] = bit[c2] = bit[c3] = bit[c4] = true;         // Revisit cities of changed edges
+            swapped = improved = true;
+          }
+        }
+      }
+      if(!swapped){                                         // If no swap helps the city
+        bit[c1] = false;                                      // Clear its bit
+      }
+    }
+  }
+  return change;
+}
+
 /********************************************************************************
  * guidedLocalSearch() runs the main TSP algorithm, keeping track of the
  * time and iterations limits, ass well as calling the functions to run
- * the FLS, calculate and set the tour's penalties, and output the final
- * solution.
+ * the FLS and calculate and set the tour's penalties. The final solution is
+ * written by runAlgorithm().
 ********************************************************************************/
 void GLS::guidedLocalSearch(){
   if(!hasReachedLimit()){                // If algorithm limits have not been met
 	  iteration++;                         // Increment iteration of algorithm
+    if(trace){                             // If search is traced
+      trace->log(TRACE_ITERATION, iteration);   // Mark start of iteration
+    }
       fastLocalSearch();                   // Call FLS to run
+    if(trace && hasReachedLimit()){        // If time limit cut FLS short
+      trace->stop();                         // Stop trace before this iteration
+    }
     if(iteration == maxFLS){               // If FLS has reached its limit of iterations
       setPenalties();                        // Reset the tour penalties for next iteration of GLS
     }
     updatePenalties();                     // Update the penalties for the current best tour
   }
-  else{                                 // Else
-    outputResults();                      // Call function to write final solution to file
-  }
 }
@@ -12,20 +12,51 @@
 #ifndef GLS_HPP
 #define GLS_HPP
 
+#include <queue>
+#include <unordered_map>
+#include <vector>
 #include "tsp.hpp"
 
+class TRC;
+
+/********************************************************************************
+ * Utility is a heap entry for a tour edge. It records the edge's cities and
+ * the distance and penalty the utility distance/(1+penalty) was computed
+ * from, so entries made stale by a swap or a later penalty can be skipped.
+********************************************************************************/
+struct Utility{
+  int distance;            // Distance of edge
+  int penalty;             // Penalty of edge when entry was pushed
+  int c1;                  // First city of edge
+  int c2;                  // Second city of edge
+
+  bool operator<(const Utility &other) const{          // Compare utilities without floating point division
+    return (long long)distance*(1 + other.penalty) <
+           (long long)other.distance*(1 + penalty);
+  }
+};
+
 class GLS: public TSP{
   public:
     double alpha;          // Parameter to tune lambda
     int lambda;            // Parameter to tune algorithm
 	int maxFLS;            // Maximum fast local search iterations
 
-    int *utility;          // Edge utilities
+    std::priority_queue<Utility> utility;   // Max-heap of tour edge utilities
+    int *pos;              // Cities' positions in current tour
     bool *bit;             // City penalty bits
-    int **penalty;         // Edge penalties
+    bool *active;          // Cities in the searched region, or NULL to search all
+    int *nearest;          // Nearest cities of each city, for parallel segment search
+    int *home;             // Segment of each city during parallel segment search
+    int *partner;          // City at the other end of each city's fixed edge, or -1; NULL if none are fixed
+    int **augmented;       // Augmented cost of each edge, distance plus lambda times penalty, one contiguous row per city
+    std::unordered_map<long long, int> penalties;   // Penalty of each penalized edge, by getEdgeKey()
+
+    int segments;          // Count of tour segments searched in parallel for the first local optimum
+    int simd;              // Widest vector unit used to scan neighbors: 0 scalar, 1 AVX2, 2 AVX-512
+    TRC *trace;            // Trace that moves and penalties are written to or checked against, or NULL
 
-    int costChange;        // Cost change by swapping edges
-    int penaltyChange;     // Penalty change by swapping edges
+    int costChange;        // Cost change by the last beneficial swap evaluated
 
   public:
     GLS();                                  // Constructor
@@ -33,15 +64,35 @@ class GLS: public TSP{
 
     void setAlpha(double);                  // Set alpha variable
     void setLambda();                       // Calculate lambda
+    void setAugmentedCost(int, int);        // Recalculate augmented cost of edge
+    long long getEdgeKey(int, int);         // Get key of edge between two cities in penalty map
+    int getPenalty(int, int);               // Get penalty of edge between two cities
     void setFlsIterations(int);             // Set count of FLS iterations
+    void setSegments(int);                  // Set count of segments searched in parallel
+    void setPartners(int*);                 // Set fixed edges that moves may not remove
 
     void initialize();                      // Initialize dynamic arrays
+    void initializeSearch();                // Initialize GLS arrays for current tour
+    size_t getArenaSize();                  // Get bytes needed by all arrays
+    void setStartTour(const int*);          // Continue search from a given tour
+    void takePendingTour();                 // Take a finished background tour if it is better
     void setPenalties();                    // Reset edge penalties
     void updatePenalties();                 // Update edge penalties
+    void setUtilities();                    // Rebuild utility heap from current tour
+    void pushUtility(int, int);             // Push utility of edge between two cities
+    bool isTourEdge(int, int);              // Check if edge between two cities is in current tour
+    bool isActive(int);                     // Check if city is in the searched region
+    bool isFixed(int, int);                 // Check if edge between two cities is fixed
 
     int	getSwapCost(int, int);              // Calculate cost of swapping edges
     void twoOptSwap(int, int, int*);        // Swap edges
     bool twoOPT(int, int);                  // 2-opt algorithm
+    int findSwap(int, int);                 // Find next neighbor with a beneficial swap
+    bool hasSwap(int, int);                 // Check if a city and neighbor have a beneficial swap
+    int findSwapAVX2(int, int);             // Check 8 neighbors for beneficial swaps at once
+    int findSwapAVX512(int, int);           // Check 16 neighbors for beneficial swaps at once
+    void parallelLocalSearch();             // Descend to a local optimum on segments in parallel
+    int segmentLocalSearch(int, int);       // Run 2-opt within one tour segment
     void fastLocalSearch();                 // Fast Local Search algorithm
     void guidedLocalSearch();               // Guided Local Search algorithm
 };
@@ -0,0 +1,99 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the ILS class. Here, you
+ *              can find initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include "ils.hpp"
+
+/********************************************************************************
+ * Constructor initializes driving variables.
+********************************************************************************/
+ILS::ILS(){
+  setKickWindow(50);         // Confine kicks to 50 consecutive tour positions
+}
+
+/********************************************************************************
+ * setKickWindow() initializes the kick window to programmer's input.
+********************************************************************************/
+void ILS::setKickWindow(int limit){
+  kickWindow = limit;
+}
+
+/********************************************************************************
+ * initialize() creates the GLS arrays, leaving lambda and all penalties at 0
+ * so the local search works on plain distances, and runs the fast local
+ * search from the first tour to reach a first local optimum.
+********************************************************************************/
+void ILS::initialize(){
+  GLS::initialize();                     // Call GLS class initializing function
+  fastLocalSearch();                     // Descend to first local optimum
+  if(tourCost < bestCost){               // If the local optimum is the best tour
+    setBest();                             // Set it as the best tour
+  }
+}
+
+/********************************************************************************
+ * doubleBridge() picks three cut points inside a random window of the tour
+ * and exchanges the two segments between them, A B C D becoming A C B D.
+ * No segment is reversed. The penalty bits of the six cities at the changed
+ * edges are set so the local search re-optimizes only around the kick.
+********************************************************************************/
+void ILS::doubleBridge(){
+  int window = min(kickWindow, size - 1);          // Positions the kick is confined to
+  int first = generator() % (size - window);       // First position of window
+  int cut[3];                                      // Cut points, after which edges are removed
+  do{                                              // Until cut points are distinct
+    for(int i = 0; i < 3; i++){                      // For each cut point
+      cut[i] = first + generator() % window;           // Pick a position in window
+    }
+    std::sort(cut, cut + 3);                         // Order cut points
+  }while(cut[0] == cut[1] || cut[1] == cut[2]);
+
+  int a1 = tour[cut[0]], a2 = tour[cut[0]+1];      // Cities at first removed edge
+  int b1 = tour[cut[1]], b2 = tour[cut[1]+1];      // Cities at second removed edge
+  int c1 = tour[cut[2]], c2 = tour[getNext(cut[2])];   // Cities at third removed edge
+
+  tourCost += distance[a1][b2] + distance[c1][a2] + distance[b1][c2] -   // Add cost of new edges
+              distance[a1][a2] - distance[b1][b2] - distance[c1][c2];    // Subtract cost of removed edges
+
+  std::rotate(tour + cut[0] + 1, tour + cut[1] + 1, tour + cut[2] + 1);   // Exchange segments
+  for(int i = cut[0] + 1; i <= cut[2]; i++){       // For each moved city
+    pos[tour[i]] = i;                                // Record its new position
+  }
+
+  bit[a1] = bit[a2] = bit[b1] = bit[b2] = bit[c1] = bit[c2] = true;   // Re-optimize kicked cities
+}
+
+/********************************************************************************
+ * restoreBest() copies the best tour back into the current tour.
+********************************************************************************/
+void ILS::restoreBest(){
+  for(int i = 0; i < size; i++){     // For each city
+    tour[i] = best[i];                 // Copy best tour city to current tour
+    pos[tour[i]] = i;                  // Record its position
+  }
+  tourCost = bestCost;               // Copy best tour cost to current tour cost
+}
+
+/********************************************************************************
+ * guidedLocalSearch() runs one iteration of the ILS algorithm: a kick,
+ * a local search of the kicked cities, and the acceptance test. A tour no
+ * worse than the best tour is accepted, otherwise the best tour is restored.
+********************************************************************************/
+void ILS::guidedLocalSearch(){
+  if(hasReachedLimit() || size < 8){     // If algorithm limits have been met or tour is too small to kick
+    return;
+  }
+  doubleBridge();                        // Kick the tour
+  fastLocalSearch();                     // Re-optimize around the kick
+  if(tourCost <= bestCost){              // If kicked tour is no worse than the best tour
+    setBest();                             // Accept it
+  }
+  else{                                  // Else
+    restoreBest();                         // Reject it
+  }
+}
@@ -0,0 +1,31 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The ILS class defines variables and functions to drive an
+ *              iterated local search TSP algorithm. Each iteration kicks the
+ *              current tour with a double-bridge move confined to a small
+ *              window of the tour, re-optimizes the kicked cities with the
+ *              GLS class's fast local search and 2-opt without penalties,
+ *              and keeps the result if it is no worse than the best tour.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef ILS_HPP
+#define ILS_HPP
+
+#include "gls.hpp"
+
+class ILS: public GLS{
+  public:
+	int kickWindow;          // Count of tour positions a kick is confined to
+
+  public:
+    ILS();                                  // Constructor
+
+    void setKickWindow(int);                // Set count of positions a kick is confined to
+
+    void initialize();                      // Initialize dynamic arrays and first local optimum
+    void doubleBridge();                    // Kick the tour with a local double-bridge move
+    void restoreBest();                     // Return the current tour to the best tour
+    void guidedLocalSearch();               // Iterated Local Search algorithm
+};
+#endif
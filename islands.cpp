@@ -0,0 +1,535 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the ISM class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include "islands.hpp"
+
+#define MIN_EPOCH 0.5              // Shortest default time between exchanges, in seconds
+
+/********************************************************************************
+ * sendLine() writes a whole line to a socket. Returns false if the other end
+ * has disconnected.
+********************************************************************************/
+static bool sendLine(int out, const string &line){
+  size_t sent = 0;                                      // Bytes written so far
+  while(sent < line.size()){                            // While bytes are left
+    ssize_t count = write(out, line.data() + sent, line.size() - sent);
+    if(count <= 0){                                       // If other end has disconnected
+      return false;
+    }
+    sent += count;
+  }
+  return true;
+}
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+ISM::ISM(){
+  setMaxTime(179);              // Maximum time - specify 180 seconds or INT_MAX
+  setEpoch(0);                  // Pick exchange period from time limit
+  setIslands(std::thread::hardware_concurrency());   // Use one island per core
+  setPort(0);                   // Initialize to no remote islands
+  setHugePages(false);          // Initialize to regular pages
+  setChristofides(true);        // Initialize to Christofides start for large problems
+  setProfile(NULL);             // Initialize to size table parameters
+  stopped = 0;                  // Initialize count of crashed islands to 0
+  size = 0;                     // Initialize problem size to 0
+  iterations = 0;               // Initialize island iterations to 0
+  board = NULL;                 // Initialize to no board
+  boardBytes = 0;
+  listener = -1;                // Initialize to no listening socket
+}
+
+/********************************************************************************
+ * Deconstructor unmaps the board.
+********************************************************************************/
+ISM::~ISM(){
+  if(board){                       // If board is mapped
+    munmap(board, boardBytes);       // Unmap it
+  }
+}
+
+/********************************************************************************
+ * setMaxTime() initializes the algorithm time limit.
+********************************************************************************/
+void ISM::setMaxTime(double limit){
+  maxTime = limit;
+}
+
+/********************************************************************************
+ * setEpoch() initializes the time between exchanges. A value of 0 uses a
+ * twentieth of the time limit, but at least half a second.
+********************************************************************************/
+void ISM::setEpoch(double length){
+  epoch = length;
+}
+
+/********************************************************************************
+ * setIslands() initializes the count of island processes on this host. With
+ * a port, the count may be 0, so every island is remote.
+********************************************************************************/
+void ISM::setIslands(int count){
+  islands = max(count, 0);
+}
+
+/********************************************************************************
+ * setPort() initializes the TCP port remote islands join on, 0 for none.
+********************************************************************************/
+void ISM::setPort(int number){
+  port = number;
+}
+
+/********************************************************************************
+ * setHugePages() sets whether each island's arena is backed by transparent
+ * huge pages.
+********************************************************************************/
+void ISM::setHugePages(bool enable){
+  hugePages = enable;
+}
+
+/********************************************************************************
+ * setChristofides() sets whether the first island starts a large problem
+ * from a Christofides tour. The other islands always start from their own
+ * random tours, so they do not all search from the same tour.
+********************************************************************************/
+void ISM::setChristofides(bool enable){
+  christofides = enable;
+}
+
+/********************************************************************************
+ * setProfile() sets the profile that picks each island's GLS parameters.
+********************************************************************************/
+void ISM::setProfile(TUN *tuner){
+  profile = tuner;
+}
+
+/********************************************************************************
+ * getDuration() returns the seconds since the coordinator started.
+********************************************************************************/
+double ISM::getDuration(){
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/********************************************************************************
+ * setProblem() counts the cities of the input file and maps the board in
+ * POSIX shared memory. The name of the memory is removed as soon as it is
+ * mapped, since the islands inherit the mapping, so nothing is left behind
+ * if the coordinator is killed.
+********************************************************************************/
+bool ISM::setProblem(string input){
+  start = std::chrono::steady_clock::now();             // Set program timer
+  fileName = input;
+  size = TSP::countCities(input);                       // Count cities in file
+  if(size < 1){                                         // If file cannot be read
+    cout << "ERROR: FILE NOT FOUND" << endl;              // Print error message
+    return false;
+  }
+
+  boardBytes = sizeof(Board) + (size_t)size*sizeof(int);   // Record followed by tour
+  string name = "/tsp-islands-" + std::to_string(getpid());
+  int memory = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  void *block = MAP_FAILED;
+  if(memory >= 0){                                      // If shared memory was created
+    if(ftruncate(memory, boardBytes) == 0){               // If it was sized
+      block = mmap(NULL, boardBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0);
+    }
+    close(memory);
+    shm_unlink(name.c_str());                             // Remove name, mapping stays
+  }
+  if(block == MAP_FAILED){                              // If board could not be mapped
+    cout << "ERROR: CANNOT MAP SHARED MEMORY" << endl;    // Print error message
+    return false;
+  }
+
+  board = (Board*)block;
+  pthread_mutexattr_t attributes;
+  pthread_mutexattr_init(&attributes);
+  pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);   // Lock across processes
+  pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);      // Survive an owner's crash
+  pthread_mutex_init(&board->lock, &attributes);
+  pthread_mutexattr_destroy(&attributes);
+  board->cost = INT_MAX;                                // No tour published yet
+  board->island = -1;
+  board->publishes = 0;
+  board->imports = 0;
+  board->iterations = 0;
+  return true;
+}
+
+/********************************************************************************
+ * runAlgorithm() forks the islands, serves remote islands if a port was
+ * given, and waits for every island to finish. An island that crashes is
+ * counted and the others go on. Remote islands are served until the time
+ * limit, and then for one more exchange period while any is connected, so
+ * their last tours arrive. The best tour of the board is then written.
+********************************************************************************/
+void ISM::runAlgorithm(){
+  signal(SIGPIPE, SIG_IGN);                             // Report disconnected islands as write errors
+  double length = (epoch > 0) ? epoch : max(MIN_EPOCH, maxTime/20);   // Time between exchanges
+
+  cout.flush();                                         // Do not repeat buffered output in islands
+  vector<pid_t> children;                               // Island processes
+  for(int i = 0; i < islands; i++){                     // For each island
+    pid_t child = fork();
+    if(child == 0){                                       // If this is the island
+      runIsland(i, [this, i](GLS &obj){ exchangeLocal(obj, i); });
+      lockBoard();
+      board->iterations += iterations;                      // Count its iterations
+      unlockBoard();
+      _exit(0);                                             // End island without the coordinator's cleanup
+    }
+    if(child > 0){                                        // If island was started
+      children.push_back(child);
+    }
+  }
+
+  std::thread acceptor;                                 // Thread serving remote islands
+  if(port > 0 && TSP::readCities(fileName, x, y) && listenIslands()){   // If remote islands can join
+    acceptor = std::thread(&ISM::acceptIslands, this);
+  }
+
+  for(unsigned i = 0; i < children.size(); i++){        // For each island
+    int status;
+    waitpid(children[i], &status, 0);                     // Wait for it to finish
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){   // If it crashed
+      cout << "Island " << i << " stopped";
+      if(WIFSIGNALED(status)){
+        cout << " by signal " << WTERMSIG(status);
+      }
+      cout << endl;
+      stopped++;
+    }
+  }
+
+  if(acceptor.joinable()){                              // If remote islands were served
+    auto connected = [this]{ std::lock_guard<std::mutex> guard(lock); return !connections.empty(); };
+    while(getDuration() < maxTime || (getDuration() < maxTime + length && connected())){
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));   // Wait for their last tours
+    }
+    shutdown(listener, SHUT_RDWR);                        // Stop accepting islands
+    acceptor.join();
+    close(listener);
+    std::unique_lock<std::mutex> guard(lock);
+    for(std::set<int>::iterator it = connections.begin(); it != connections.end(); ++it){
+      shutdown(*it, SHUT_RDWR);                             // End each remaining connection
+    }
+    closed.wait(guard, [this]{ return connections.empty(); });
+  }
+  outputResults();                                      // Call function to print algorithm results
+}
+
+/********************************************************************************
+ * runRemote() runs one island on this host that joins the coordinator at
+ * "host:port" over TCP, sending its best tour after each exchange period and
+ * taking the coordinator's best tour when it is better. If the coordinator
+ * cannot be reached or disconnects, the island searches on alone. The island
+ * prints its result but writes no tour file; the coordinator does.
+********************************************************************************/
+bool ISM::runRemote(string input, string address){
+  signal(SIGPIPE, SIG_IGN);                             // Report a disconnected coordinator as a write error
+  start = std::chrono::steady_clock::now();             // Set program timer
+  fileName = input;
+  size_t colon = address.rfind(':');                    // Host and port are split at the last colon
+  string host = colon == string::npos ? "localhost" : address.substr(0, colon);
+  string service = colon == string::npos ? address : address.substr(colon + 1);
+
+  int connection = -1;                                  // Socket to coordinator
+  addrinfo hints = {}, *found = NULL;
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if(getaddrinfo(host.c_str(), service.c_str(), &hints, &found) == 0){   // If address was resolved
+    for(addrinfo *a = found; a && connection < 0; a = a->ai_next){   // For each address of host
+      connection = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if(connection >= 0 && connect(connection, a->ai_addr, a->ai_addrlen) < 0){
+        close(connection);
+        connection = -1;
+      }
+    }
+    freeaddrinfo(found);
+  }
+  if(connection < 0){                                   // If coordinator cannot be reached
+    cout << "ERROR: CANNOT CONNECT TO " << address << endl;   // Print error message, search alone
+  }
+  FILE *in = connection >= 0 ? fdopen(dup(connection), "r") : NULL;   // Answers from coordinator
+
+  int imports = 0;                                      // Count of tours taken from coordinator
+  int cost = INT_MAX;                                   // Best tour distance of island
+  runIsland(-1, [&](GLS &obj){
+    cost = obj.bestCost;
+    if(!in){                                              // If island is alone
+      return;
+    }
+    string line = "tour " + std::to_string(obj.bestCost) + " " + std::to_string(obj.size);
+    for(int i = 0; i < obj.size; i++){                    // For each city in best tour
+      line += " " + std::to_string(obj.best[i]);
+    }
+    line += "\n";
+    char word[64];
+    int best = 0, count = 0;                              // Coordinator's best tour distance and length
+    bool complete = sendLine(connection, line) &&
+                    fscanf(in, "%63s %d %d", word, &best, &count) == 3 && string(word) == "tour" &&
+                    (count == 0 || count == obj.size);
+    vector<int> tour(count);
+    for(int i = 0; i < count && complete; i++){           // For each city of coordinator's tour
+      complete = fscanf(in, "%d", &tour[i]) == 1 && tour[i] >= 0 && tour[i] < obj.size;
+    }
+    if(!complete){                                        // If coordinator disconnected or is out of step
+      fclose(in);
+      in = NULL;                                            // Search on alone
+      return;
+    }
+    if(count > 0 && best < obj.bestCost){                 // If coordinator's tour is better
+      obj.setStartTour(tour.data());                        // Continue search from it
+      imports++;
+    }
+    cost = obj.bestCost;
+  });
+  if(in){
+    fclose(in);
+  }
+  if(connection >= 0){
+    close(connection);
+  }
+  cout << "Iterations: " << iterations << "    Best Tour: " << cost
+       << "    Imports: " << imports << endl;
+  return connection >= 0;
+}
+
+/********************************************************************************
+ * runIsland() creates the island's GLS object with its own random numbers,
+ * and searches in periods, calling the exchange after each period, until
+ * the time limit or the iteration limit is reached. The first island starts
+ * a large problem from a Christofides tour, and the others from random tours.
+********************************************************************************/
+void ISM::runIsland(int island, std::function<void(GLS&)> exchange){
+  double length = (epoch > 0) ? epoch : max(MIN_EPOCH, maxTime/20);   // Time between exchanges
+  GLS obj;                                              // Island's algorithm object
+  obj.setSeed(rand() ^ getpid());                       // Differ from islands forked alike
+  obj.setHugePages(hugePages);                          // Set page size of arena
+  obj.setChristofides(christofides && island <= 0);     // Set start tour
+  obj.setMaxTime(maxTime);                              // Set time limit
+  if(!obj.TSP::setProblem(fileName)){                   // If cities cannot be read
+    return;
+  }
+  obj.initialize();                                     // Initialize dynamic arrays
+  if(profile){                                          // If a profile is set
+    profile->setParameters(obj);                          // Apply its parameters
+  }
+
+  while(obj.getDuration() < maxTime){                   // While time is left
+    obj.setMaxTime(min(maxTime, obj.getDuration() + length));   // Search until end of period
+    obj.search();
+    exchange(obj);                                        // Trade best tours
+    if(obj.iteration >= obj.maxGLS){                      // If island cannot search further
+      break;
+    }
+  }
+  iterations = obj.iteration;
+}
+
+/********************************************************************************
+ * exchangeLocal() trades an island's best tour through the board, continuing
+ * its search from the board's tour if that is better.
+********************************************************************************/
+void ISM::exchangeLocal(GLS &obj, int island){
+  vector<int> tour(obj.best, obj.best + obj.size);      // Island's best tour
+  int cost = obj.bestCost;
+  if(trade(tour, cost, island)){                        // If board's tour is better
+    obj.setStartTour(tour.data());                        // Continue search from it
+  }
+}
+
+/********************************************************************************
+ * trade() publishes a tour to the board if it is better than the board's, or
+ * else replaces it with the board's tour if that is better. Returns whether
+ * the tour was replaced.
+********************************************************************************/
+bool ISM::trade(vector<int> &tour, int &cost, int island){
+  bool taken = false;                                   // Track if board's tour was taken
+  lockBoard();
+  int *shared = board->getTour();                       // Board's best tour
+  if(cost < board->cost){                               // If tour is better than board's
+    std::copy(tour.begin(), tour.end(), shared);          // Publish it
+    board->cost = cost;
+    board->island = island;
+    board->publishes++;
+  }
+  else if(board->cost < cost){                          // Else, if board's tour is better
+    tour.assign(shared, shared + size);                   // Take it
+    cost = board->cost;
+    board->imports++;
+    taken = true;
+  }
+  unlockBoard();
+  return taken;
+}
+
+/********************************************************************************
+ * lockBoard() locks the board. If an island died holding the lock, the tour
+ * it may have been writing is dropped; the islands publish their best tours
+ * again at the next exchange.
+********************************************************************************/
+void ISM::lockBoard(){
+  if(pthread_mutex_lock(&board->lock) == EOWNERDEAD){   // If lock's owner crashed
+    board->cost = INT_MAX;                                // Drop its tour
+    pthread_mutex_consistent(&board->lock);               // Make lock usable again
+  }
+}
+
+/********************************************************************************
+ * unlockBoard() unlocks the board.
+********************************************************************************/
+void ISM::unlockBoard(){
+  pthread_mutex_unlock(&board->lock);
+}
+
+/********************************************************************************
+ * listenIslands() listens for remote islands on the port on every address of
+ * this host. Returns false if the port cannot be served.
+********************************************************************************/
+bool ISM::listenIslands(){
+  listener = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  int reuse = 1;
+  if(listener >= 0){                                    // If socket was created
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));   // Allow restart on same port
+    if(bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, 64) < 0){
+      close(listener);
+      listener = -1;
+    }
+  }
+  if(listener < 0){                                     // If port cannot be served
+    cout << "ERROR: CANNOT LISTEN ON PORT " << port << endl;   // Print error message
+    return false;
+  }
+  cout << "Listening on port " << port << endl;
+  return true;
+}
+
+/********************************************************************************
+ * acceptIslands() serves each connecting remote island on its own thread
+ * until the listening socket is shut down.
+********************************************************************************/
+void ISM::acceptIslands(){
+  int connection;
+  while((connection = accept(listener, NULL, NULL)) >= 0){   // For each connecting island
+    std::lock_guard<std::mutex> guard(lock);
+    connections.insert(connection);
+    std::thread(&ISM::serveIsland, this, connection).detach();   // Serve island on own thread
+  }
+}
+
+/********************************************************************************
+ * serveIsland() reads a remote island's tours until it disconnects. A tour
+ * that is not a permutation of the cities or whose cost is wrong ends the
+ * connection. Each tour is traded through the board, and the island is
+ * answered with the board's tour if it is better, or else with none.
+********************************************************************************/
+void ISM::serveIsland(int connection){
+  FILE *in = fdopen(dup(connection), "r");              // Read from own descriptor
+  char word[64];
+  int cost, count;                                      // Island's tour distance and length
+  while(in && fscanf(in, "%63s %d %d", word, &cost, &count) == 3 &&
+        string(word) == "tour" && count == size){         // For each tour of the problem's size
+    vector<int> tour(size);
+    bool complete = true;                                 // Track if every city was read
+    for(int i = 0; i < size && complete; i++){            // For each city
+      complete = fscanf(in, "%d", &tour[i]) == 1;
+    }
+    if(!complete || !checkTour(tour, cost)){              // If tour is cut short or wrong
+      sendLine(connection, "error bad tour\n");
+      break;
+    }
+    string line;                                          // Answer to island
+    if(trade(tour, cost, -1)){                            // If board's tour is better
+      line = "tour " + std::to_string(cost) + " " + std::to_string(size);
+      for(int i = 0; i < size; i++){                        // For each city in board's tour
+        line += " " + std::to_string(tour[i]);
+      }
+      line += "\n";
+    }
+    else{                                                 // Else, island holds the best tour
+      line = "tour " + std::to_string(cost) + " 0\n";
+    }
+    if(!sendLine(connection, line)){                      // If island disconnected
+      break;
+    }
+  }
+  if(in){
+    fclose(in);
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  connections.erase(connection);
+  close(connection);
+  closed.notify_all();                                  // Wake coordinator waiting for connections
+}
+
+/********************************************************************************
+ * checkTour() returns whether a remote tour visits every city exactly once
+ * and its cost is the length of the tour.
+********************************************************************************/
+bool ISM::checkTour(const vector<int> &tour, int cost){
+  if(tour.size() != (size_t)size){                      // If tour has the wrong count of cities
+    return false;
+  }
+  vector<bool> seen(size, false);                       // Cities visited
+  for(int i = 0; i < size; i++){                        // For each city in tour
+    int a = tour[i];
+    if(a < 0 || a >= size || seen[a]){                    // If it is unknown or repeated
+      return false;
+    }
+    seen[a] = true;
+  }
+  long length = 0;                                      // Length of tour
+  for(int i = 0; i < size; i++){                        // For each edge of the checked tour
+    int a = tour[i], b = tour[(i + 1) % size];
+    length += TSP::getDistance(x[a], y[a], x[b], y[b]);
+  }
+  return length == cost;
+}
+
+/********************************************************************************
+ * outputResults() writes the best tour of the board through a TSP object's
+ * output, and prints the count of islands, tours published and taken, and
+ * crashed islands.
+********************************************************************************/
+void ISM::outputResults(){
+  lockBoard();
+  int cost = board->cost;                               // Best tour distance of board
+  best.assign(board->getTour(), board->getTour() + size);
+  TSP result;                                           // Object writing the tour file
+  result.size = size;
+  result.best = best.data();
+  result.bestCost = cost;
+  result.fileName = fileName;
+  result.iteration = board->iterations;
+  result.time = getDuration();
+  cout << "Islands: " << islands << "    Published: " << board->publishes
+       << "    Imports: " << board->imports << "    Stopped: " << stopped << endl;
+  unlockBoard();
+
+  if(cost == INT_MAX){                                  // If no island published a tour
+    cout << "ERROR: NO ISLAND FINISHED" << endl;          // Print error message
+    return;
+  }
+  result.outputResults();
+}
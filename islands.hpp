@@ -0,0 +1,105 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The ISM class runs an island model: several solver processes,
+ *              each a full GLS with its own distance matrix and random
+ *              numbers, search the same problem and trade their best tours.
+ *              The coordinator forks the islands on this host, which trade
+ *              through a board in POSIX shared memory guarded by a robust
+ *              process-shared mutex, so an island that crashes stops only
+ *              itself, even if it dies holding the lock. Islands on other
+ *              hosts join over TCP with the line protocol
+ *
+ *                tour [cost] [n] [city] ... [city]
+ *
+ *              sent by the island after each exchange period, answered with
+ *              the best tour of the board, or with "tour [cost] 0" if the
+ *              island's tour is the best. The coordinator checks a remote
+ *              tour against the coordinates before taking it, and writes the
+ *              best tour of the board to the normal tour file.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef ISLANDS_HPP
+#define ISLANDS_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <pthread.h>
+#include <set>
+#include <vector>
+#include "gls.hpp"
+#include "tuning.hpp"
+
+using std::vector;
+
+/********************************************************************************
+ * Board is the shared memory record of the best tour any island has
+ * published. The tour's cities follow the record.
+********************************************************************************/
+struct Board{
+	pthread_mutex_t lock;            // Guards the board across processes
+	int cost;                        // Best tour distance, INT_MAX until one is published
+	int island;                      // Island that published it, -1 for a remote island
+	int publishes;                   // Count of better tours published
+	int imports;                     // Count of best tours taken by islands
+	long iterations;                 // GLS iterations of islands that finished
+
+	int *getTour(){ return (int*)(this + 1); }   // Best tour
+};
+
+class ISM{
+  public:
+	double maxTime;          // Time limit
+	double epoch;            // Time between exchanges
+	int islands;             // Count of island processes on this host
+	int port;                // TCP port remote islands join on, or 0
+	int stopped;             // Count of islands that crashed
+	bool hugePages;          // Back GLS arenas with transparent huge pages
+	bool christofides;       // First island starts a large problem from Christofides
+	TUN *profile;            // Parameters of islands, or NULL for size tables
+	int size;                // Count of cities
+	long iterations;         // GLS iterations of this process's island
+	string fileName;         // Input file name
+
+	Board *board;            // Best tour shared by islands
+	size_t boardBytes;       // Size of board mapping
+	vector<int> x;           // Cities' x values, to check remote tours
+	vector<int> y;           // Cities' y values
+	vector<int> best;        // Best tour written to the tour file
+
+	int listener;                                   // Socket remote islands connect to, or -1
+	std::mutex lock;                                // Guards connections
+	std::condition_variable closed;                 // Signals a connection has closed
+	std::set<int> connections;                      // Sockets of connected remote islands
+
+	std::chrono::steady_clock::time_point start;    // Coordinator start time
+
+  public:
+	ISM();                                     // Constructor
+	~ISM();                                    // Deconstructor
+
+	void setMaxTime(double);                   // Set max time for running algorithm
+	void setEpoch(double);                     // Set time between exchanges
+	void setIslands(int);                      // Set count of island processes
+	void setPort(int);                         // Set TCP port remote islands join on
+	void setHugePages(bool);                   // Set whether GLS arenas use huge pages
+	void setChristofides(bool);                // Set whether large problems start from Christofides
+	void setProfile(TUN*);                     // Set profile picking parameters of islands
+	double getDuration();                      // Get coordinator elapsed time
+
+	bool setProblem(string);                   // Count cities and map the board
+	void runAlgorithm();                       // Run islands and write the best tour
+	bool runRemote(string, string);            // Run one island joining a coordinator over TCP
+	void runIsland(int, std::function<void(GLS&)>);   // Search, exchanging after each period
+	void exchangeLocal(GLS&, int);             // Trade best tours through the board
+	bool trade(vector<int>&, int&, int);       // Publish a tour, or take the board's if better
+	void lockBoard();                          // Lock board, recovering from a crashed island
+	void unlockBoard();                        // Unlock board
+	bool listenIslands();                      // Listen for remote islands
+	void acceptIslands();                      // Serve each connecting remote island
+	void serveIsland(int);                     // Trade tours with one remote island
+	bool checkTour(const vector<int>&, int);   // Check a remote tour and its cost
+	void outputResults();                      // Write best tour to output file
+};
+#endif
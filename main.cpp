@@ -13,18 +13,372 @@
  *   http://cswww.essex.ac.uk/CSP/glsdemo.html/tsp_x11.tar.Z
  *   http://www.cplusplus.com/reference/algorithm/random_shuffle/
 ********************************************************************************/
+#include <thread>
 #include "tsp.hpp"
 #include "gls.hpp"
+#include "ils.hpp"
+#include "decomposition.hpp"
+#include "population.hpp"
+#include "dynamic.hpp"
+#include "server.hpp"
+#include "tuning.hpp"
+#include "exact.hpp"
+#include "portfolio.hpp"
+#include "backbone.hpp"
+#include "planner.hpp"
+#include "tempering.hpp"
+#include "islands.hpp"
+#include "trace.hpp"
 
+#define DECOMPOSITION_SIZE 20000   // Problems larger than this are decomposed
+
+/********************************************************************************
+ * Usage: ./tsp [-t seconds] [-e gls|ils|portfolio|tempering] [-d] [-p threads] [-H]
+ *              [-r] [-j segments] [-k runs] [-m megabytes] [-i previous.tour -u delta.txt]
+ *              [-s socket] [-P profile] [-I islands] [-L port] [-J host:port]
+ *              [-S seed] [-W trace] [file name]
+ *        ./tsp -R trace [file name]
+ *        ./tsp -T profile [-t seconds] [file name] ...
+ *   -t  time limit in seconds (default 179)
+ *   -e  search engine: guided local search (default), iterated local search,
+ *       a portfolio of strategies sharing time by their rate of improvement,
+ *       or parallel tempering of annealed replicas, one per core, at least 4
+ *   -d  solve by spatial decomposition, the default above 20,000 cities
+ *   -p  run a population of GLS threads recombined by partition crossover
+ *   -H  back the solver's arena with transparent huge pages
+ *   problems of at most 25 cities are solved exactly
+ *   -j  reach the first local optimum by 2-opt on tour segments in parallel
+ *   -r  renumber cities along a Hilbert curve for memory locality
+ *   -k  fix edges common to short GLS runs and search the contracted problem
+ *   -m  memory limit the representation is planned for (default cgroup limit or
+ *       physical memory); decomposition is used if the matrices do not fit
+ *   -i  previous tour of the file, re-optimized after the changes given by -u
+ *   -u  cities added, removed or moved since the previous tour
+ *   -s  serve jobs on a Unix domain socket, or on stdin and stdout for "-";
+ *       a file name given with it is the master instance of subset jobs
+ *   -P  pick GLS parameters from a profile (default tsp.profile, if present)
+ *   -I  run this many GLS island processes trading best tours in shared memory
+ *   -L  also let remote islands join the islands over TCP on this port
+ *   -J  run one island joining the islands of another host at host:port
+ *   -S  seed the random numbers, so a run can be repeated
+ *   -W  write the moves and penalties of a GLS search to a binary trace
+ *   -R  replay a trace without a time limit, timing FLS and penalty updates
+ *   -T  train a profile on the files with trials of the time limit (default 2)
+********************************************************************************/
 int main(int argc, char *argv[]){
-  srand(time(NULL));                                  // Seed random functions
-  string fileName = argv[1];                          // Get file name from user input
+  string fileName;                                    // Input file name
+  double maxTime = 179;                               // Time limit
+  bool decompose = false;                             // Track if decomposition was requested
+  string engine = "gls";                              // Search engine
+  int population = 0;                                 // Count of population threads
+  bool hugePages = false;                             // Track if huge pages were requested
+  bool renumber = false;                              // Track if renumbering was requested
+  int segments = 1;                                   // Count of segments searched in parallel
+  int backbone = 0;                                   // Count of short runs finding the backbone
+  size_t memory = 0;                                  // Memory limit in megabytes, 0 for the system's
+  string tourFile, deltaFile;                         // Previous tour and changes since it
+  string socketPath;                                  // Socket served for jobs
+  vector<string> files;                               // Input file names, several when training
+  string profileFile = "tsp.profile";                 // Profile of GLS parameters
+  bool profileGiven = false;                          // Track if a profile was requested
+  string trainFile;                                   // Profile to train
+  bool timed = false;                                 // Track if a time limit was given
+  int islands = 0;                                    // Count of island processes
+  int port = 0;                                       // Port remote islands join on
+  string joinAddress;                                 // Coordinator a remote island joins
+  unsigned seed = time(NULL);                         // Seed of random numbers
+  string traceFile;                                   // Trace written by the search
+  string replayFile;                                  // Trace replayed
+
+  for(int i = 1; i < argc; i++){                      // For each argument
+    string arg = argv[i];
+    if(arg == "-t" && i+1 < argc){                      // If time limit is given
+      maxTime = atof(argv[++i]);                          // Read time limit
+      timed = true;
+    }
+    else if(arg == "-e" && i+1 < argc){                 // If search engine is given
+      engine = argv[++i];                                 // Read engine name
+    }
+    else if(arg == "-d"){                               // If decomposition is requested
+      decompose = true;
+    }
+    else if(arg == "-H"){                               // If huge pages are requested
+      hugePages = true;
+    }
+    else if(arg == "-r"){                               // If renumbering is requested
+      renumber = true;
+    }
+    else if(arg == "-j" && i+1 < argc){                 // If parallel local search is requested
+      segments = atoi(argv[++i]);                         // Read count of segments
+    }
+    else if(arg == "-k" && i+1 < argc){                 // If backbone search is requested
+      backbone = atoi(argv[++i]);                         // Read count of short runs
+    }
+    else if(arg == "-m" && i+1 < argc){                 // If memory limit is given
+      memory = atol(argv[++i]);                           // Read limit in megabytes
+    }
+    else if(arg == "-i" && i+1 < argc){                 // If previous tour is given
+      tourFile = argv[++i];
+    }
+    else if(arg == "-u" && i+1 < argc){                 // If changes are given
+      deltaFile = argv[++i];
+    }
+    else if(arg == "-s" && i+1 < argc){                 // If server mode is requested
+      socketPath = argv[++i];
+    }
+    else if(arg == "-P" && i+1 < argc){                 // If a profile is given
+      profileFile = argv[++i];
+      profileGiven = true;
+    }
+    else if(arg == "-T" && i+1 < argc){                 // If training is requested
+      trainFile = argv[++i];
+    }
+    else if(arg == "-I" && i+1 < argc){                 // If island model is requested
+      islands = atoi(argv[++i]);                          // Read count of islands
+    }
+    else if(arg == "-L" && i+1 < argc){                 // If remote islands may join
+      port = atoi(argv[++i]);                             // Read port
+    }
+    else if(arg == "-J" && i+1 < argc){                 // If this is a remote island
+      joinAddress = argv[++i];                            // Read coordinator's address
+    }
+    else if(arg == "-S" && i+1 < argc){                 // If a seed is given
+      seed = strtoul(argv[++i], NULL, 10);                // Read seed
+    }
+    else if(arg == "-W" && i+1 < argc){                 // If a trace is requested
+      traceFile = argv[++i];
+    }
+    else if(arg == "-R" && i+1 < argc){                 // If a replay is requested
+      replayFile = argv[++i];
+    }
+    else if(arg == "-p" && i+1 < argc){                 // If population search is requested
+      population = atoi(argv[++i]);                       // Read count of threads
+    }
+    else{                                               // Else, argument is the file name
+      fileName = arg;
+      files.push_back(arg);
+    }
+  }
+  if((fileName == "" && socketPath == "") ||            // If no file name or socket was given,
+     (engine != "gls" && engine != "ils" && engine != "portfolio" && engine != "tempering") ||   // or an unknown engine,
+     tourFile.empty() != deltaFile.empty() ||            // or only one of -i and -u,
+     ((traceFile != "" || replayFile != "") &&           // or a trace of anything but one GLS search
+      (engine != "gls" || decompose || population > 0 || backbone > 0 || socketPath != "" ||
+       tourFile != "" || islands > 0 || port > 0 || joinAddress != ""))){
+    cout << "Usage: ./tsp [-t seconds] [-e gls|ils|portfolio|tempering] [-d] [-p threads] [-H] "
+            "[-r] [-j segments] [-k runs] [-m megabytes] [-i previous.tour -u delta.txt] [-s socket] [-P profile] "
+            "[-I islands] [-L port] [-J host:port] [-S seed] [-W trace] [file name]" << endl;
+    cout << "       ./tsp -R trace [file name]" << endl;
+    cout << "       ./tsp -T profile [-t seconds] [file name] ..." << endl;
+    return 1;
+  }
+
+  srand(seed);                                        // Seed random functions
+
+  if(replayFile != ""){                               // If a trace is replayed
+    TRC trace;                                          // Create a trace object
+    if(!trace.open(replayFile)){                        // If trace cannot be read
+      return 1;
+    }
+    GLS obj;                                            // Create a GLS object
+    obj.setHugePages(hugePages);                        // Set page size of arena
+    obj.setRenumber(trace.header.renumber);             // Order cities as recording did
+    obj.setChristofides(false);                         // Start tour is read from trace
+    if(!obj.TSP::setProblem(fileName.c_str())){         // If cities cannot be read
+      return 1;
+    }
+    return trace.replay(obj) ? 0 : 1;                   // Replay and report times
+  }
+
+  if(trainFile != ""){                                // If training was requested
+    TUN tuner;                                          // Create a tuning object
+    tuner.train(files, timed ? maxTime : 2,             // Run trials and fit settings
+                memory > 0 ? memory << 20 : PLN::getSystemLimit());
+    if(!tuner.saveProfile(trainFile)){                  // If profile cannot be written
+      cout << "ERROR: CANNOT WRITE " << trainFile << endl;
+      return 1;
+    }
+    cout << "Profile: " << trainFile << endl;
+    return 0;
+  }
+
+  TUN tuner;                                          // Parameters of the profile
+  if(!tuner.loadProfile(profileFile) && profileGiven){   // If requested profile cannot be read
+    cout << "ERROR: CANNOT READ " << profileFile << endl;
+    return 1;
+  }
+
+  if(socketPath != ""){                               // If server mode was requested
+    SRV obj;                                            // Create a server object
+    obj.setHugePages(hugePages);                        // Set page size of arenas
+    obj.setProfile(&tuner);                             // Set parameters of jobs
+    if(memory > 0){                                     // If memory limit was given
+      obj.setLimit(memory << 20);                         // Fit job arenas to it
+    }
+    MST master;                                         // Master instance of subset jobs
+    if(fileName != ""){                                 // If a master instance was given
+      if(!master.setProblem(fileName)){                   // If it cannot be read
+        return 1;
+      }
+      if(socketPath != "-"){                              // If stdout is not the job channel
+        cout << "Master: " << master.size << " cities" << endl;
+      }
+      obj.setMaster(&master);                             // Serve subset jobs from it
+    }
+    return obj.runServer(socketPath) ? 0 : 1;           // Serve jobs until stopped
+  }
+
+  if(!tourFile.empty()){                              // If a previous tour is re-optimized
+    DYN obj;                                            // Create a dynamic object
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setHugePages(hugePages);                        // Set page size of arena
+    if(obj.setProblem(fileName, tourFile, deltaFile)){  // If changes are applied successfully
+      obj.initialize();                                   // Repair previous tour
+      tuner.setParameters(obj);                           // Apply profile parameters
+      obj.TSP::runAlgorithm();                            // Run the algorithm
+    }
+    return 0;
+  }
 
-  GLS obj;                                            // Create an algorithm object
-  if(obj.TSP::setProblem(fileName.c_str())){            // If algorithm successfully initializes the tour
-	obj.initialize();                                   // Initialize dynamic arrays
-    obj.TSP::runAlgorithm();                            // Run the algorithm
+  int cities = TSP::countCities(fileName);            // Count cities in file
+  if(!decompose && population == 0 && traceFile == "" &&   // If problem is small enough to solve exactly
+     cities > 0 && cities <= EXACT_SIZE){
+    EXA obj;                                            // Create an exact object
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setHugePages(hugePages);                        // Set page size of arena
+    obj.setRenumber(renumber);                          // Set order of cities
+    if(obj.TSP::setProblem(fileName)){                  // If cities are read successfully
+      obj.initialize();                                   // Create first tour
+      obj.runAlgorithm();                                 // Solve and write results
+    }
+    return 0;
+  }
+
+  PLN planner;                                        // Planner of memory representation
+  if(memory > 0){                                     // If memory limit was given
+    planner.setLimit(memory << 20);                     // Plan for it instead of the system's
+  }
+  bool island = islands > 0 || port > 0 || joinAddress != "";   // Track if islands search
+  bool single = population == 0 && backbone == 0 &&    // Track if one object searches
+                (engine == "gls" || engine == "ils");
+  int requested = island ? (joinAddress != "" ? 1 : islands) :   // Search objects requested by engine
+                  population > 0 ? max(population, 2) :
+                  backbone > 0 ? max(backbone, 2) + 1 :
+                  engine == "portfolio" ? 3 : 1;     // Tempering counts its polisher alone, replicas have no edge store
+  int least = population > 0 ? 2 : (single || engine == "tempering") ? 1 : 3;   // Fewest search objects engine runs with
+  if(decompose || cities > DECOMPOSITION_SIZE ||      // If decomposition was requested, the problem is too large,
+     !(island ? planner.planIslands(cities, requested) :   // or its matrices do not fit
+                planner.planDense(cities, requested, least, single ? segments : 1, renumber, single))){
+    if(traceFile != ""){                                // If one GLS search was to be traced
+      cout << "ERROR: CANNOT TRACE A DECOMPOSED PROBLEM" << endl;
+      return 1;
+    }
+    DEC obj;                                            // Create a decomposition object
+    planner.planParts(cities, obj.partSize, obj.threads);   // Fit threads to memory limit
+    planner.printPlan();                                // Print memory plan
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setThreads(planner.workers);                    // Set count of threads
+    obj.setProfile(&tuner);                             // Set parameters of part searches
+    if(obj.setProblem(fileName)){                       // If cities are read successfully
+      obj.runAlgorithm();                                 // Run the algorithm
+    }
+    return 0;
+  }
+  planner.printPlan();                                // Print memory plan
+
+  if(island){                                         // If island model was requested
+    ISM obj;                                            // Create an island object
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setHugePages(hugePages);                        // Set page size of arenas
+    obj.setChristofides(planner.christofides);          // Set start tour that fits
+    obj.setProfile(&tuner);                             // Set parameters of islands
+    if(joinAddress != ""){                              // If this is a remote island
+      return obj.runRemote(fileName, joinAddress) ? 0 : 1;   // Search, trading with coordinator
+    }
+    obj.setIslands(min(islands, planner.workers));      // Set count of islands that fit
+    obj.setPort(port);                                  // Set port remote islands join on
+    if(obj.setProblem(fileName)){                       // If cities are counted successfully
+      obj.runAlgorithm();                                 // Run the algorithm
+    }
+    return 0;
+  }
+
+  if(population > 0){                                 // If population search was requested
+    POP obj;                                            // Create a population object
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setThreads(planner.workers);                    // Set count of threads that fit
+    obj.setHugePages(hugePages);                        // Set page size of arenas
+    obj.setRenumber(renumber);                          // Set order of cities
+    obj.setProfile(&tuner);                             // Set parameters of GLS objects
+    if(obj.setProblem(fileName)){                       // If cities are read successfully
+      obj.runAlgorithm();                                 // Run the algorithm
+    }
+    return 0;
+  }
+
+  if(backbone > 0){                                   // If backbone search was requested
+    BKB obj;                                            // Create a backbone object
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setRuns(planner.workers - 1);                   // Set count of short runs that fit
+    obj.setHugePages(hugePages);                        // Set page size of arenas
+    obj.setRenumber(renumber);                          // Set order of cities
+    obj.setProfile(&tuner);                             // Set parameters of GLS objects
+    if(obj.setProblem(fileName)){                       // If cities are read successfully
+      obj.runAlgorithm();                                 // Run the algorithm
+    }
+    return 0;
+  }
+
+  if(engine == "tempering"){                          // If parallel tempering was requested
+    PTE obj;                                            // Create a tempering object
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setHugePages(hugePages);                        // Set page size of arenas
+    obj.setRenumber(renumber);                          // Set order of cities
+    if(obj.TSP::setProblem(fileName)){                  // If cities are read successfully
+      obj.initialize();                                   // Create replicas
+      obj.runAlgorithm();                                 // Run the algorithm
+    }
+    return 0;
+  }
+
+  if(engine == "portfolio"){                          // If portfolio search was requested
+    PFL obj;                                            // Create a portfolio object
+    obj.setMaxTime(maxTime);                            // Set time limit
+    obj.setHugePages(hugePages);                        // Set page size of arenas
+    obj.setRenumber(renumber);                          // Set order of cities
+    obj.setProfile(&tuner);                             // Set parameters of strategies
+    if(obj.setProblem(fileName)){                       // If cities are read successfully
+      obj.runAlgorithm();                                 // Run the algorithm
+    }
+    return 0;
+  }
+
+  GLS *obj;                                           // Algorithm object
+  if(engine == "ils"){                                // If iterated local search was chosen
+    obj = new ILS;                                      // Create an ILS object
+  }
+  else{                                               // Else
+    obj = new GLS;                                      // Create a GLS object
+  }
+  obj->setMaxTime(maxTime);                           // Set time limit
+  obj->setHugePages(hugePages);                       // Set page size of arena
+  obj->setRenumber(renumber);                         // Set order of cities
+  obj->setSegments(segments);                         // Set count of parallel segments
+  obj->setChristofides(planner.christofides);          // Set start tour that fits
+  if(obj->TSP::setProblem(fileName.c_str())){           // If algorithm successfully initializes the tour
+	obj->initialize();                                  // Initialize dynamic arrays
+    tuner.setParameters(*obj);                          // Apply profile parameters
+    TRC trace;                                          // Trace of search
+    if(traceFile != "" && !trace.record(*obj, traceFile, seed)){   // If trace cannot be written
+      delete obj;
+      return 1;
+    }
+    obj->TSP::runAlgorithm();                           // Run the algorithm
+    if(!trace.finish()){                                // If trace could not be written
+      cout << "ERROR: CANNOT WRITE " << traceFile << endl;
+    }
   }
+  delete obj;                                         // Delete algorithm object
 
   return 0;                                           // End program
 }
@@ -0,0 +1,84 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the MST class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include "master.hpp"
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+MST::MST(){
+  size = 0;                     // Initialize to no cities
+}
+
+/********************************************************************************
+ * setProblem() reads the master instance and ranks its cities along a
+ * Hilbert curve over their bounding box, computing the curve positions of
+ * blocks of cities on several threads. Returns false if the file cannot be
+ * read.
+********************************************************************************/
+bool MST::setProblem(string input){
+  string error;                                         // Reason file cannot be read
+  if(!TSP::readCities(input, x, y, &error)){            // If file cannot be read
+    cout << "ERROR: " << error << endl;                   // Print error message
+    return false;
+  }
+  size = x.size();
+
+  int minX = INT_MAX, maxX = INT_MIN, minY = INT_MAX, maxY = INT_MIN;
+  for(int i = 0; i < size; i++){                        // For each city
+    minX = min(minX, x[i]); maxX = max(maxX, x[i]);       // Extend bounding box
+    minY = min(minY, y[i]); maxY = max(maxY, y[i]);
+  }
+  double span = max((double)maxX - minX, (double)maxY - minY);   // Longer side, which may not fit an int
+  double scale = 65535.0 / max(1.0, span);              // Fit box in curve's grid
+
+  vector<std::pair<long, int> > keys(size);             // Curve position and city
+  TSP::forRows(size, [&](int first, int last){
+    for(int i = first; i < last; i++){                    // For each city
+      keys[i].first = TSP::getHilbertIndex(((double)x[i] - minX)*scale, ((double)y[i] - minY)*scale);
+      keys[i].second = i;
+    }
+  });
+  std::sort(keys.begin(), keys.end());                  // Order cities along curve
+  rank.resize(size);
+  for(int i = 0; i < size; i++){                        // For each place on curve
+    rank[keys[i].second] = i;                             // Record city's rank
+  }
+  return true;
+}
+
+/********************************************************************************
+ * getSubset() gathers the coordinates of the cities with the given master
+ * IDs, and sets the first tour to the subset's places ordered by the cities'
+ * ranks, in O(k log k) for k cities. Returns false if an ID is outside the
+ * master instance or given twice.
+********************************************************************************/
+bool MST::getSubset(const vector<int> &ids, vector<int> &xs, vector<int> &ys, vector<int> &tour){
+  int count = ids.size();                               // Count of cities in subset
+  vector<std::pair<int, int> > keys(count);             // Rank and place in subset
+  xs.resize(count);
+  ys.resize(count);
+  for(int i = 0; i < count; i++){                       // For each city in subset
+    if(ids[i] < 0 || ids[i] >= size){                     // If it is not in the master instance
+      return false;
+    }
+    xs[i] = x[ids[i]];                                    // Gather coordinates
+    ys[i] = y[ids[i]];
+    keys[i] = std::make_pair(rank[ids[i]], i);
+  }
+  std::sort(keys.begin(), keys.end());                  // Order subset along master's curve
+  tour.resize(count);
+  for(int i = 0; i < count; i++){                       // For each place on curve
+    if(i > 0 && keys[i].first == keys[i-1].first){        // If a city was given twice
+      return false;
+    }
+    tour[i] = keys[i].second;                             // Record subset place
+  }
+  return true;
+}
@@ -0,0 +1,34 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The MST class holds a master instance that many jobs pick
+ *              subsets of cities from. The master file is read once, and
+ *              its cities are ranked along a Hilbert curve over the whole
+ *              instance, a spatial index shared by every subset. A subset's
+ *              coordinates are gathered from the master by ID, and its first
+ *              tour is its cities in the order of their ranks, so a subset
+ *              needs neither an input file nor a curve of its own.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef MASTER_HPP
+#define MASTER_HPP
+
+#include <vector>
+#include "tsp.hpp"
+
+using std::vector;
+
+class MST{
+  public:
+	int size;                // Count of cities in master instance
+	vector<int> x;           // Cities' x values
+	vector<int> y;           // Cities' y values
+	vector<int> rank;        // Place of each city along the master's Hilbert curve
+
+  public:
+	MST();                                     // Constructor
+
+	bool setProblem(string);                   // Read master instance and rank its cities
+	bool getSubset(const vector<int>&, vector<int>&, vector<int>&, vector<int>&);   // Gather a subset and its first tour
+};
+#endif
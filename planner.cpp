@@ -0,0 +1,160 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the PLN class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <unistd.h>
+#include "gls.hpp"
+#include "planner.hpp"
+
+#define CHRISTOFIDES_CITY_SIZE 256   // Bytes per city of a Christofides tour's own arrays
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+PLN::PLN(){
+  setLimit(getSystemLimit());   // Initialize to the machine's limit
+  dense = true;                 // Initialize to dense representation
+  christofides = true;          // Initialize to Christofides start tours
+  workers = 1;                  // Initialize to one search object
+  bytes = 0;                    // Initialize footprint to 0
+}
+
+/********************************************************************************
+ * setLimit() initializes the memory limit in bytes.
+********************************************************************************/
+void PLN::setLimit(size_t bound){
+  limit = bound;
+}
+
+/********************************************************************************
+ * getSystemLimit() returns the cgroup memory limit of the process, version 2
+ * or version 1, or the machine's physical memory if it is lower or there is
+ * no cgroup limit.
+********************************************************************************/
+size_t PLN::getSystemLimit(){
+  size_t bound = (size_t)sysconf(_SC_PHYS_PAGES)*sysconf(_SC_PAGE_SIZE);   // Physical memory
+  const char *files[] = {"/sys/fs/cgroup/memory.max",                      // cgroup version 2
+                         "/sys/fs/cgroup/memory/memory.limit_in_bytes"};   // cgroup version 1
+  for(int i = 0; i < 2; i++){                     // For each cgroup file
+    ifstream file(files[i]);
+    unsigned long long value;
+    if(file >> value && value < bound){             // If it holds a number below physical memory
+      bound = value;                                  // Use it, "max" means no limit
+    }
+  }
+  return bound;
+}
+
+/********************************************************************************
+ * getSolverSize() returns the bytes of a GLS object's arena for a count of
+ * cities, whether it shares another object's distances, its count of parallel
+ * segments and whether it renumbers cities. The arena is sized by the
+ * object's own getArenaSize(), so the estimate and the mapping agree.
+********************************************************************************/
+size_t PLN::getSolverSize(int cities, bool shared, int segments, bool renumber){
+  GLS probe;                                      // Object sized without being mapped
+  probe.size = cities;
+  probe.shared = shared;
+  probe.renumber = renumber;
+  probe.setSegments(segments);
+  return probe.getArenaSize();
+}
+
+/********************************************************************************
+ * getChristofidesSize() returns the bytes a Christofides tour allocates for a
+ * count of cities. It reads the solver's distance matrix, so only its
+ * vertices, spanning tree, matching and tours are its own, a few hundred
+ * bytes per city.
+********************************************************************************/
+size_t PLN::getChristofidesSize(int cities){
+  return (size_t)cities*CHRISTOFIDES_CITY_SIZE;
+}
+
+/********************************************************************************
+ * planDense() finds the most search objects, from the requested count down to
+ * the least the engine can run with, whose dense arenas fit the limit: the
+ * first owning the distances and the others sharing them. Objects above
+ * 5,000 cities each build a Christofides tour at once when initialized, unless
+ * they search parallel segments from a Hilbert tour. If the engine can start
+ * from random tours instead, that is tried before giving up objects. Returns
+ * false if no count fits.
+********************************************************************************/
+bool PLN::planDense(int cities, int requested, int least, int segments, bool renumber, bool flexible){
+  size_t owner = getSolverSize(cities, false, segments, renumber);   // Object owning the distances
+  size_t sharer = getSolverSize(cities, true, segments, renumber);   // Object sharing them
+  bool builds = cities > CHRISTOFIDES_SIZE && segments <= 1;         // Objects build Christofides tours
+  dense = true;
+  for(workers = requested; workers >= least; workers--){   // For each count of objects
+    for(int pass = 0; pass < (flexible ? 2 : 1); pass++){    // Christofides starts, then random
+      christofides = (pass == 0);
+      bytes = owner + (workers - 1)*sharer +
+              (builds && christofides ? workers*getChristofidesSize(cities) : 0);
+      if(bytes <= limit){                                    // If plan fits
+        return true;
+      }
+    }
+  }
+  dense = false;
+  return false;
+}
+
+/********************************************************************************
+ * planIslands() finds the most island processes, from the requested count
+ * down to one, that fit the limit. Each island owns its distances, and only
+ * the first builds a Christofides tour; if that does not fit, every island
+ * starts from a random tour. Returns false if no island fits.
+********************************************************************************/
+bool PLN::planIslands(int cities, int requested){
+  size_t owner = getSolverSize(cities, false, 1, false);   // Island's own arena
+  bool builds = cities > CHRISTOFIDES_SIZE;                // First island builds a Christofides tour
+  dense = true;
+  for(workers = max(requested, 1); workers >= 1; workers--){   // For each count of islands
+    for(int pass = 0; pass < 2; pass++){                     // Christofides start, then random
+      christofides = (pass == 0);
+      bytes = workers*owner + (builds && christofides ? getChristofidesSize(cities) : 0);
+      if(bytes <= limit){                                    // If plan fits
+        return true;
+      }
+    }
+  }
+  dense = false;
+  return false;
+}
+
+/********************************************************************************
+ * planParts() finds the most threads, up to the given count, whose part
+ * arenas fit the limit next to the O(n) arrays of the whole problem.
+********************************************************************************/
+void PLN::planParts(int cities, int partSize, int threads){
+  size_t whole = 4*(size_t)cities*sizeof(int);       // Coordinates, part order and tour
+  size_t part = getSolverSize(partSize, false, 1, false);   // One part's arena
+  dense = false;
+  christofides = false;
+  for(workers = max(threads, 1); workers > 1; workers--){   // For each count of threads
+    if(whole + workers*part <= limit){                 // If plan fits
+      break;
+    }
+  }
+  bytes = whole + workers*part;
+}
+
+/********************************************************************************
+ * printPlan() prints the chosen representation, its estimated footprint and
+ * the memory limit.
+********************************************************************************/
+void PLN::printPlan(){
+  cout << "Plan: ";
+  if(dense){                                          // If dense representation was chosen
+    cout << "dense distances and edge store, " << workers << " search object" << (workers > 1 ? "s" : "")
+         << ", " << (christofides ? "Christofides" : "random") << " start";
+  }
+  else{                                               // Else, decomposition was chosen
+    cout << "decomposition, " << workers << " thread" << (workers > 1 ? "s" : "");
+  }
+  cout << ", " << (bytes >> 20) << " MB of " << (limit >> 20) << " MB"
+       << (bytes > limit ? " (over limit)" : "") << endl;
+}
@@ -0,0 +1,43 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The PLN class picks how a problem is held in memory before
+ *              anything is allocated. The memory limit is given by the user,
+ *              or read from the cgroup limit, or else is the machine's
+ *              physical memory. Each search object's arena is sized by the
+ *              same getArenaSize() the object maps it with. The planner tries,
+ *              in order: dense distances and edge store for every requested
+ *              search object with Christofides start tours; the same with
+ *              random start tours, which skip Christofides' spanning tree
+ *              and matching; fewer search objects; and, if nothing fits, spatial
+ *              decomposition, which holds only O(n) for the whole problem and
+ *              one part's matrices per thread, with fewer threads if needed.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef PLANNER_HPP
+#define PLANNER_HPP
+
+#include <cstddef>
+
+class PLN{
+  public:
+	size_t limit;            // Memory limit in bytes
+	bool dense;              // Dense distances and edge store fit
+	bool christofides;       // Christofides start tours fit
+	int workers;             // Count of search objects, or of threads solving parts
+	size_t bytes;            // Estimated footprint of plan
+
+  public:
+	PLN();                                     // Constructor
+
+	void setLimit(size_t);                     // Set memory limit in bytes
+	static size_t getSystemLimit();            // Get cgroup limit or physical memory
+	static size_t getSolverSize(int, bool, int, bool);   // Get bytes of a GLS object's arena
+	static size_t getChristofidesSize(int);    // Get bytes of a Christofides tour's matrices
+
+	bool planDense(int, int, int, int, bool, bool);   // Fit dense representation, or return false
+	bool planIslands(int, int);                // Fit island processes, or return false
+	void planParts(int, int, int);             // Fit decomposition threads
+	void printPlan();                          // Print the plan
+};
+#endif
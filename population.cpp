@@ -0,0 +1,306 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the POP class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+ *   Whitley, Hains, Howe, "Tunneling between optima: partition crossover
+ *   for the traveling salesman problem", GECCO 2009
+********************************************************************************/
+#include <algorithm>
+#include <thread>
+#include "population.hpp"
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+POP::POP(){
+  setMaxTime(179);              // Maximum time - specify 180 seconds or INT_MAX
+  setThreads(std::thread::hardware_concurrency());   // Use one thread per core
+  setEpoch(0);                  // Pick epoch from time limit
+  bestCost = 0;                 // Initialize best tour cost to 0
+  recombinations = 0;           // Initialize count of recombinations to 0
+  hugePages = false;            // Initialize to regular pages
+  renumber = false;             // Initialize to file order
+  profile = NULL;               // Initialize to size table parameters
+}
+
+/********************************************************************************
+ * Deconstructor deletes the GLS objects, sharing ones before the owner.
+********************************************************************************/
+POP::~POP(){
+  for(int i = workers.size() - 1; i >= 0; i--){   // For each GLS object, owner last
+    delete workers[i];                              // Delete GLS object
+  }
+}
+
+/********************************************************************************
+ * setMaxTime() initializes the algorithm time limit.
+********************************************************************************/
+void POP::setMaxTime(double limit){
+  maxTime = limit;
+}
+
+/********************************************************************************
+ * setThreads() initializes the count of GLS objects.
+********************************************************************************/
+void POP::setThreads(int count){
+  threads = max(count, 2);
+}
+
+/********************************************************************************
+ * setEpoch() initializes the time between recombinations. A value of 0 uses
+ * a twentieth of the time limit, but at least half a second.
+********************************************************************************/
+void POP::setEpoch(double limit){
+  epoch = limit;
+}
+
+/********************************************************************************
+ * setHugePages() sets whether each GLS object's arena is backed by
+ * transparent huge pages.
+********************************************************************************/
+void POP::setHugePages(bool enable){
+  hugePages = enable;
+}
+
+/********************************************************************************
+ * setRenumber() sets whether the cities are renumbered along a Hilbert curve
+ * when read.
+********************************************************************************/
+void POP::setRenumber(bool enable){
+  renumber = enable;
+}
+
+/********************************************************************************
+ * setProfile() sets the profile that picks each GLS object's parameters.
+********************************************************************************/
+void POP::setProfile(TUN *tuner){
+  profile = tuner;
+}
+
+/********************************************************************************
+ * setProblem() reads in cities into the first GLS object, then creates the
+ * other GLS objects sharing its coordinates and distances, and initializes
+ * each object on its own thread so the pages of its tours and edge store are
+ * first touched, and so placed, by the thread that searches them.
+********************************************************************************/
+bool POP::setProblem(string input){
+  workers.push_back(new GLS);                          // Create GLS object owning the distances
+  workers[0]->setHugePages(hugePages);
+  workers[0]->setRenumber(renumber);
+  if(!workers[0]->TSP::setProblem(input)){             // If cities cannot be read
+    return false;                                        // End function by returning false
+  }
+  for(int i = 1; i < threads; i++){                    // For each other GLS object
+    workers.push_back(new GLS);                          // Create GLS object
+    workers[i]->setHugePages(hugePages);
+    workers[i]->TSP::setProblem(*workers[0]);            // Share cities and distances
+  }
+
+  vector<std::thread> pool;                            // Worker threads
+  for(int i = 0; i < threads; i++){                    // For each GLS object
+    pool.push_back(std::thread([this, i](){
+      workers[i]->initialize();                          // Initialize dynamic arrays
+      if(profile){                                       // If a profile is set
+        workers[i]->setMaxTime(maxTime);                   // Describe problem at population's time limit
+        profile->setParameters(*workers[i]);               // Apply its parameters
+      }
+    }));
+  }
+  for(int i = 0; i < threads; i++){                    // For each thread
+    pool[i].join();                                      // Wait for initialization to finish
+  }
+
+  best.assign(workers[0]->best, workers[0]->best + workers[0]->size);   // Record first best tour
+  bestCost = workers[0]->bestCost;
+  return true;                                         // End function by returning true
+}
+
+/********************************************************************************
+ * runAlgorithm() alternates epochs of GLS on every thread with
+ * recombination until the time limit is reached or every GLS object has
+ * reached its iteration limit, then writes the best tour found.
+********************************************************************************/
+void POP::runAlgorithm(){
+  double length = (epoch > 0) ? epoch : max(0.5, maxTime/20);   // Time between recombinations
+  GLS *owner = workers[0];                             // GLS object owning the timer
+
+  while(owner->getDuration() < maxTime){               // While time is left
+    runEpoch(min(maxTime, owner->getDuration() + length));   // Search until end of epoch
+    recombine();                                         // Recombine best tours
+
+    bool finished = true;                                // Track if every object reached its iteration limit
+    for(int i = 0; i < threads; i++){
+      finished = finished && workers[i]->iteration >= workers[i]->maxGLS;
+    }
+    if(finished){                                        // If no object can search further
+      break;
+    }
+  }
+  outputResults();                                     // Call function to print algorithm results
+}
+
+/********************************************************************************
+ * runEpoch() runs every GLS object on its own thread until the given time.
+********************************************************************************/
+void POP::runEpoch(double until){
+  vector<std::thread> pool;                            // Worker threads
+  for(int i = 0; i < threads; i++){                    // For each GLS object
+    workers[i]->setMaxTime(until);                       // Set end of epoch as its time limit
+    pool.push_back(std::thread([this, i](){ workers[i]->search(); }));
+  }
+  for(int i = 0; i < threads; i++){                    // For each thread
+    pool[i].join();                                      // Wait for epoch to finish
+  }
+}
+
+/********************************************************************************
+ * recombine() crosses each thread's best tour with the next thread's best
+ * tour. An offspring better than the thread's best tour becomes its new
+ * starting tour. The overall best tour is updated along the way.
+********************************************************************************/
+void POP::recombine(){
+  int size = workers[0]->size;                         // Count of cities
+  vector<vector<int> > parents(threads);               // Best tours at end of epoch
+  for(int i = 0; i < threads; i++){                    // For each GLS object
+    parents[i].assign(workers[i]->best, workers[i]->best + size);
+  }
+
+  vector<int> child(size);                             // Offspring tour
+  for(int i = 0; i < threads; i++){                    // For each GLS object
+    int cost = partitionCrossover(parents[i].data(), parents[(i+1) % threads].data(), child.data());
+    if(cost < workers[i]->bestCost){                     // If offspring improves the object's best tour
+      workers[i]->setStartTour(child.data());              // Continue search from offspring
+      recombinations++;
+    }
+    if(workers[i]->bestCost < bestCost){                 // If object holds the best tour found
+      best.assign(workers[i]->best, workers[i]->best + size);
+      bestCost = workers[i]->bestCost;
+    }
+  }
+}
+
+/********************************************************************************
+ * partitionCrossover() removes the edges two parent tours share from the
+ * union of their edges and splits the remaining graph into connected
+ * components. A component that both tours enter and leave exactly once is
+ * one path in each parent between the same two cities, so the offspring
+ * follows the first parent and takes the second parent's path through every
+ * such component where it is shorter. Returns the offspring's cost, which
+ * is never more than the first parent's.
+********************************************************************************/
+int POP::partitionCrossover(const int *a, const int *b, int *child){
+  int size = workers[0]->size;                         // Count of cities
+  int **distance = workers[0]->distance;               // Distances between cities
+  vector<int> posA(size), posB(size);                  // Cities' positions in parents
+  for(int i = 0; i < size; i++){
+    posA[a[i]] = i;
+    posB[b[i]] = i;
+  }
+  auto isEdge = [size](const int *t, const vector<int> &pos, int u, int v){   // Check if edge is in a tour
+    int p = pos[u];
+    return t[(p + 1) % size] == v || t[(p + size - 1) % size] == v;
+  };
+
+  vector<int> root(size);                              // Union-find parent of each city
+  for(int i = 0; i < size; i++){
+    root[i] = i;
+  }
+  auto find = [&root](int u){                          // Find component of city
+    while(root[u] != u){
+      u = root[u] = root[root[u]];
+    }
+    return u;
+  };
+  vector<char> unshared(size, 0);                      // Cities touching an edge the parents do not share
+  for(int i = 0; i < size; i++){                       // For each edge of both parents
+    int u = a[i], v = a[(i + 1) % size];
+    if(!isEdge(b, posB, u, v)){                          // If first parent's edge is not shared
+      root[find(u)] = find(v);  unshared[u] = unshared[v] = 1;     // Join its cities' components
+    }
+    u = b[i], v = b[(i + 1) % size];
+    if(!isEdge(a, posA, u, v)){                          // If second parent's edge is not shared
+      root[find(u)] = find(v);  unshared[u] = unshared[v] = 1;
+    }
+  }
+  auto component = [&](int u){ return unshared[u] ? find(u) : -1; };
+
+  vector<int> crossings(size, 0), members(size, 0);    // Per component: edges leaving it, count of cities
+  vector<long> lengthA(size, 0), lengthB(size, 0);     // Per component: length of each parent's path
+  for(int i = 0; i < size; i++){                       // For each edge of both parents
+    int cu = component(a[i]), cv = component(a[(i + 1) % size]);
+    if(cu != cv){                                        // If first parent's edge leaves a component
+      if(cu >= 0) crossings[cu]++;
+      if(cv >= 0) crossings[cv]++;
+    }
+    else if(cu >= 0){                                    // Else, if it lies inside one
+      lengthA[cu] += distance[a[i]][a[(i + 1) % size]];
+    }
+    cu = component(b[i]), cv = component(b[(i + 1) % size]);
+    if(cu == cv && cu >= 0){                             // If second parent's edge lies inside a component
+      lengthB[cu] += distance[b[i]][b[(i + 1) % size]];
+    }
+    if(component(a[i]) >= 0){
+      members[component(a[i])]++;
+    }
+  }
+  vector<char> chosen(size, 0);                        // Components taken from second parent
+  for(int c = 0; c < size; c++){
+    chosen[c] = crossings[c] == 2 && lengthB[c] < lengthA[c];
+  }
+
+  int first = 0;                                       // Position to start walking first parent
+  while(first < size){                                 // Find a city that does not lie inside a chosen path
+    int c = component(a[first]);
+    if(c < 0 || !chosen[c] || component(a[(first + size - 1) % size]) != c){
+      break;
+    }
+    first++;
+  }
+
+  int length = 0;                                      // Count of cities placed in offspring
+  for(int i = 0; i < size; ){                          // Walk first parent
+    int u = a[(first + i) % size];                       // Get next city
+    int c = component(u);
+    if(c >= 0 && chosen[c]){                             // If it enters a chosen component
+      int p = posB[u];                                     // Walk second parent's path from it
+      int step = (component(b[(p + 1) % size]) == c) ? 1 : size - 1;
+      for(int j = 0; j < members[c]; j++){
+        child[length++] = b[p];
+        p = (p + step) % size;
+      }
+      i += members[c];                                     // Skip first parent's path
+    }
+    else{                                                // Else
+      child[length++] = u;                                 // Keep first parent's city
+      i++;
+    }
+  }
+
+  int cost = 0;                                        // Cost of offspring
+  for(int i = 0; i < size; i++){
+    cost += distance[child[i]][child[(i + 1) % size]];
+  }
+  return cost;
+}
+
+/********************************************************************************
+ * outputResults() hands the best tour to the owning GLS object, which writes
+ * it to the output file and prints the final limits to the terminal.
+********************************************************************************/
+void POP::outputResults(){
+  GLS *owner = workers[0];                             // GLS object owning the output
+  int iterations = 0;                                  // Iterations of all objects
+  for(int i = 0; i < threads; i++){
+    iterations += workers[i]->iteration;
+  }
+  std::copy(best.begin(), best.end(), owner->best);    // Copy best tour
+  owner->bestCost = bestCost;
+  owner->iteration = iterations;
+  owner->time = owner->getDuration();
+  owner->outputResults();
+  cout << "Threads: " << threads << "    "
+          "Recombinations: " << recombinations << endl;
+}
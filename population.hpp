@@ -0,0 +1,52 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The POP class runs a population of GLS objects on separate
+ *              threads, all sharing one distance matrix. After each epoch
+ *              the best tours of neighboring threads are recombined with a
+ *              partition crossover, and an offspring better than a thread's
+ *              best tour is fed back to that thread as its new starting tour.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef POPULATION_HPP
+#define POPULATION_HPP
+
+#include <vector>
+#include "gls.hpp"
+#include "tuning.hpp"
+
+using std::vector;
+
+class POP{
+  public:
+	double maxTime;          // Time limit
+	double epoch;            // Time between recombinations
+	int threads;             // Count of GLS objects
+	int	bestCost;            // Best tour distance
+	int recombinations;      // Count of offspring fed back to threads
+	bool hugePages;          // Back GLS arenas with transparent huge pages
+	bool renumber;           // Renumber cities along a Hilbert curve
+	TUN *profile;            // Parameters of GLS objects, or NULL for size tables
+
+	vector<GLS*> workers;    // GLS objects, the first owns the distances
+	vector<int> best;        // Best tour
+
+  public:
+	POP();                                     // Constructor
+	~POP();                                    // Deconstructor
+
+	void setMaxTime(double);                   // Set max time for running algorithm
+	void setThreads(int);                      // Set count of GLS objects
+	void setEpoch(double);                     // Set time between recombinations
+	void setHugePages(bool);                   // Set whether GLS arenas use huge pages
+	void setRenumber(bool);                    // Set whether cities are renumbered
+	void setProfile(TUN*);                     // Set profile picking parameters of GLS objects
+
+	bool setProblem(string);                   // Initialize record of cities
+	void runAlgorithm();                       // Run the algorithm
+	void runEpoch(double);                     // Run every GLS object until a time
+	void recombine();                          // Recombine neighboring best tours
+	int partitionCrossover(const int*, const int*, int*);   // Recombine two tours into an offspring
+	void outputResults();                      // Write best tour to output file
+};
+#endif
@@ -0,0 +1,275 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the PFL class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+ *   Waldspurger, Weihl, "Stride scheduling: deterministic proportional-share
+ *   resource management", MIT/LCS/TM-528, 1995
+********************************************************************************/
+#include <algorithm>
+#include <thread>
+#include "ils.hpp"
+#include "portfolio.hpp"
+
+#define MIN_SHARE 0.1              // Share of mean rate every strategy keeps
+#define MAX_LAG 5                  // Slices a strategy can fall behind the lowest pass
+#define STALL_SLICES 3             // Slices in a row without gain before a strategy has stalled
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+PFL::PFL(){
+  setMaxTime(179);              // Maximum time - specify 180 seconds or INT_MAX
+  setSlice(0);                  // Pick slice from time limit
+  setThreads(std::thread::hardware_concurrency());   // Use one thread per core
+  hugePages = false;            // Initialize to regular pages
+  renumber = false;             // Initialize to file order
+  profile = NULL;               // Initialize to size table parameters
+  bestCost = 0;                 // Initialize best tour cost to 0
+}
+
+/********************************************************************************
+ * Deconstructor deletes the search objects, sharing ones before the owner.
+********************************************************************************/
+PFL::~PFL(){
+  for(int i = strategies.size() - 1; i >= 0; i--){  // For each strategy, owner last
+    delete strategies[i].solver;                      // Delete search object
+  }
+}
+
+/********************************************************************************
+ * setMaxTime() initializes the algorithm time limit.
+********************************************************************************/
+void PFL::setMaxTime(double limit){
+  maxTime = limit;
+}
+
+/********************************************************************************
+ * setSlice() initializes the length of a time slice. A value of 0 uses a
+ * hundredth of the time limit, but at least a twentieth of a second.
+********************************************************************************/
+void PFL::setSlice(double limit){
+  slice = limit;
+}
+
+/********************************************************************************
+ * setThreads() initializes the count of threads running slices.
+********************************************************************************/
+void PFL::setThreads(int count){
+  threads = max(count, 1);
+}
+
+/********************************************************************************
+ * setHugePages() sets whether each strategy's arena is backed by transparent
+ * huge pages.
+********************************************************************************/
+void PFL::setHugePages(bool enable){
+  hugePages = enable;
+}
+
+/********************************************************************************
+ * setRenumber() sets whether the cities are renumbered along a Hilbert curve
+ * when read.
+********************************************************************************/
+void PFL::setRenumber(bool enable){
+  renumber = enable;
+}
+
+/********************************************************************************
+ * setProfile() sets the profile that picks each strategy's GLS parameters.
+********************************************************************************/
+void PFL::setProfile(TUN *tuner){
+  profile = tuner;
+}
+
+/********************************************************************************
+ * setProblem() reads in cities into the first strategy's object, creates the
+ * other objects sharing its coordinates and distances, and initializes each
+ * on its own thread. Iteration limits are lifted, since the portfolio spends
+ * a fixed wall-clock time. No object builds a Christofides tour in
+ * initialize(), so the random strategy stays random and only the
+ * Christofides strategy builds one, on its own initializing thread.
+********************************************************************************/
+bool PFL::setProblem(string input){
+  const char *names[] = {"gls-random", "gls-christofides", "ils"};
+  for(int i = 0; i < 3; i++){                          // For each strategy
+    Strategy s = {names[i], i == 2 ? new ILS : new GLS, 0, 0, 0, 0, false};
+    s.solver->setHugePages(hugePages);
+    s.solver->setChristofides(false);                    // Start from a random tour
+    strategies.push_back(s);
+  }
+  GLS *owner = strategies[0].solver;                   // Object owning the distances
+  owner->setRenumber(renumber);
+  if(!owner->TSP::setProblem(input)){                  // If cities cannot be read
+    return false;                                        // End function by returning false
+  }
+  for(unsigned i = 1; i < strategies.size(); i++){     // For each other object
+    strategies[i].solver->TSP::setProblem(*owner);       // Share cities and distances
+  }
+
+  vector<std::thread> pool;                            // Initializing threads
+  for(unsigned i = 0; i < strategies.size(); i++){     // For each strategy
+    pool.push_back(std::thread([this, i](){
+      GLS *solver = strategies[i].solver;
+      solver->initialize();                              // Initialize dynamic arrays
+      if(strategies[i].name == "gls-christofides"){      // If strategy starts from Christofides
+        CHR obj(solver->distance, solver->size);           // Create Christofide's class object
+        solver->setStartTour(obj.getChristofides());       // Start from its tour
+      }
+      solver->setGlsIterations(INT_MAX);                 // Search until time limit
+      if(profile){                                       // If a profile is set
+        solver->setMaxTime(maxTime);                       // Describe problem at portfolio's time limit
+        profile->setParameters(*solver);                   // Apply its parameters
+      }
+    }));
+  }
+  for(unsigned i = 0; i < pool.size(); i++){           // For each thread
+    pool[i].join();                                      // Wait for initialization to finish
+  }
+
+  bestCost = INT_MAX;
+  for(unsigned i = 0; i < strategies.size(); i++){     // For each strategy
+    GLS *solver = strategies[i].solver;
+    if(solver->bestCost < bestCost){                     // If it holds the best first tour
+      bestCost = solver->bestCost;
+      best.assign(solver->best, solver->best + solver->size);
+    }
+  }
+  return true;                                         // End function by returning true
+}
+
+/********************************************************************************
+ * runAlgorithm() runs slices on a pool of threads until the time limit, then
+ * writes the best tour found. There is always at least one fewer thread than
+ * strategies, so each free thread chooses among idle strategies by pass, and
+ * the leading strategy gets more of the time.
+********************************************************************************/
+void PFL::runAlgorithm(){
+  if(slice <= 0){                                      // If no slice length was given
+    slice = max(0.05, maxTime/100);                      // Use a hundredth of the time limit
+  }
+  int count = max(1, min(threads, (int)strategies.size() - 1));   // Count of threads
+  vector<std::thread> pool;
+  for(int i = 0; i < count; i++){                      // For each thread
+    pool.push_back(std::thread(&PFL::runWorker, this));  // Start thread
+  }
+  for(int i = 0; i < count; i++){
+    pool[i].join();                                      // Wait for time limit
+  }
+  outputResults();                                     // Call function to print algorithm results
+}
+
+/********************************************************************************
+ * runWorker() repeatedly takes the strategy with the lowest pass, gives it
+ * the best tour found if it gained nothing in its last few slices, runs it
+ * for one slice, and records its progress.
+********************************************************************************/
+void PFL::runWorker(){
+  std::chrono::steady_clock::time_point start = strategies[0].solver->start;   // Shared start time
+  while(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < maxTime){   // While time is left
+    int i;
+    GLS *solver;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      i = getStrategy();                                 // Pick strategy
+      if(i < 0){                                         // If every strategy is running
+        break;
+      }
+      strategies[i].busy = true;
+      solver = strategies[i].solver;
+      if(strategies[i].stalled >= STALL_SLICES &&          // If strategy stalled,
+         bestCost < solver->bestCost){                       // and another found a better tour
+        solver->setStartTour(best.data());                     // Continue from best tour
+        strategies[i].stalled = 0;
+      }
+    }
+
+    int before = solver->bestCost;                       // Best cost before slice
+    double begin = solver->getDuration();
+    solver->setMaxTime(min(maxTime, begin + slice));     // Set end of slice as time limit
+    solver->search();                                    // Run strategy
+    double elapsed = solver->getDuration() - begin;
+
+    std::lock_guard<std::mutex> guard(lock);
+    finishSlice(i, before, elapsed);                     // Record progress
+  }
+}
+
+/********************************************************************************
+ * getStrategy() returns the idle strategy with the lowest pass, or -1 if
+ * every strategy is running.
+********************************************************************************/
+int PFL::getStrategy(){
+  int chosen = -1;
+  for(unsigned i = 0; i < strategies.size(); i++){     // For each strategy
+    if(!strategies[i].busy && (chosen < 0 || strategies[i].pass < strategies[chosen].pass)){
+      chosen = i;
+    }
+  }
+  return chosen;
+}
+
+/********************************************************************************
+ * finishSlice() updates a strategy's improvement rate as a moving average of
+ * its slices, advances its pass by the slice length over its weight, and
+ * records its best tour if it is the best found. A strategy's weight is its
+ * rate plus a share of the mean rate, so a stalled strategy still runs now
+ * and then, and all strategies share evenly when none improves.
+********************************************************************************/
+void PFL::finishSlice(int i, int before, double elapsed){
+  Strategy &s = strategies[i];
+  GLS *solver = s.solver;
+  double gain = before - solver->bestCost;             // Improvement in slice
+  s.rate = 0.5*s.rate + 0.5*gain/max(elapsed, 1e-6);   // Moving average of rate
+  s.stalled = gain > 0 ? 0 : s.stalled + 1;            // Count slices in a row without gain
+  s.seconds += elapsed;
+  s.busy = false;
+
+  double mean = 0;                                     // Mean rate of all strategies
+  for(unsigned j = 0; j < strategies.size(); j++){
+    mean += strategies[j].rate / strategies.size();
+  }
+  vector<double> weight(strategies.size());            // Each strategy's weight
+  for(unsigned j = 0; j < strategies.size(); j++){
+    weight[j] = strategies[j].rate + MIN_SHARE*mean + 1e-9;
+  }
+  s.pass += elapsed / weight[i];                       // Advance strategy by slice over its share
+
+  double lowest = s.pass;                              // Lowest pass
+  for(unsigned j = 0; j < strategies.size(); j++){
+    lowest = min(lowest, strategies[j].pass);
+  }
+  for(unsigned j = 0; j < strategies.size(); j++){     // Keep each pass within a few of its own
+    strategies[j].pass = min(strategies[j].pass - lowest,   // slices of the lowest, so a strategy
+                             MAX_LAG*slice/weight[j]);      // that speeds up is not held back
+  }
+
+  if(solver->bestCost < bestCost){                     // If strategy holds the best tour
+    bestCost = solver->bestCost;
+    best.assign(solver->best, solver->best + solver->size);
+  }
+}
+
+/********************************************************************************
+ * outputResults() hands the best tour to the owning object, which writes it
+ * to the output file and prints the final limits, then prints each
+ * strategy's share of time.
+********************************************************************************/
+void PFL::outputResults(){
+  GLS *owner = strategies[0].solver;                   // Object owning the output
+  int iterations = 0;                                  // Iterations of all objects
+  for(unsigned i = 0; i < strategies.size(); i++){
+    iterations += strategies[i].solver->iteration;
+  }
+  std::copy(best.begin(), best.end(), owner->best);    // Copy best tour
+  owner->bestCost = bestCost;
+  owner->iteration = iterations;
+  owner->time = owner->getDuration();
+  owner->outputResults();
+  for(unsigned i = 0; i < strategies.size(); i++){     // For each strategy
+    cout << strategies[i].name << ": " << strategies[i].seconds << "s   ";
+  }
+  cout << endl;
+}
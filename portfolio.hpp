@@ -0,0 +1,69 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The PFL class runs a portfolio of search strategies on one
+ *              distance matrix, giving each strategy short slices of time on
+ *              a pool of threads. Slices are handed out by stride scheduling:
+ *              each strategy's share of time follows its recent rate of
+ *              improvement, so time moves toward whichever strategy is
+ *              improving fastest on this instance, while every strategy keeps
+ *              a small share. A strategy that made no progress in its last
+ *              few slices continues from the best tour found by any strategy.
+ *
+ *              Strategies: GLS from a random tour, GLS from a Christofides
+ *              tour, and ILS.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef PORTFOLIO_HPP
+#define PORTFOLIO_HPP
+
+#include <mutex>
+#include <vector>
+#include "gls.hpp"
+#include "tuning.hpp"
+
+using std::vector;
+
+struct Strategy{
+	string name;             // Strategy name, printed with results
+	GLS *solver;             // Search object
+	double rate;             // Recent improvement per second
+	double pass;             // Stride scheduling position, lowest runs next
+	double seconds;          // Time given to strategy
+	int stalled;             // Slices in a row without gain
+	bool busy;               // Strategy is running on a thread
+};
+
+class PFL{
+  public:
+	double maxTime;          // Time limit
+	double slice;            // Length of a time slice
+	int threads;             // Count of threads running slices
+	bool hugePages;          // Back arenas with transparent huge pages
+	bool renumber;           // Renumber cities along a Hilbert curve
+	TUN *profile;            // Parameters of strategies, or NULL for size tables
+	int bestCost;            // Best tour distance
+
+	vector<Strategy> strategies;   // Strategies, the first owns the distances
+	vector<int> best;        // Best tour of any strategy
+	std::mutex lock;         // Guards schedule and best tour
+
+  public:
+	PFL();                                     // Constructor
+	~PFL();                                    // Deconstructor
+
+	void setMaxTime(double);                   // Set max time for running algorithm
+	void setSlice(double);                     // Set length of a time slice
+	void setThreads(int);                      // Set count of threads running slices
+	void setHugePages(bool);                   // Set whether arenas use huge pages
+	void setRenumber(bool);                    // Set whether cities are renumbered
+	void setProfile(TUN*);                     // Set profile picking parameters of strategies
+
+	bool setProblem(string);                   // Initialize every strategy
+	void runAlgorithm();                       // Run the algorithm
+	void runWorker();                          // Run slices until the time limit
+	int getStrategy();                         // Pick next strategy to run
+	void finishSlice(int, int, double);        // Record progress of a slice
+	void outputResults();                      // Write best tour to output file
+};
+#endif
@@ -0,0 +1,402 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the SRV class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include <csignal>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "exact.hpp"
+#include "planner.hpp"
+#include "server.hpp"
+
+/********************************************************************************
+ * Deconstructor closes the client's connection once no job holds it.
+********************************************************************************/
+Client::~Client(){
+  if(owned){                       // If descriptor belongs to client
+    close(out);                      // Close connection
+  }
+}
+
+/********************************************************************************
+ * answer() writes one line to the client. Lines of jobs finishing at the same
+ * time are never interleaved. A client that has disconnected is ignored.
+********************************************************************************/
+void Client::answer(const string &line){
+  std::lock_guard<std::mutex> guard(lock);
+  size_t sent = 0;                                      // Bytes written so far
+  while(sent < line.size()){                            // While bytes are left
+    ssize_t count = write(out, line.data() + sent, line.size() - sent);
+    if(count <= 0){                                       // If client has disconnected
+      return;                                               // Drop answer
+    }
+    sent += count;
+  }
+}
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+SRV::SRV(){
+  setThreads(std::thread::hardware_concurrency());   // Use one thread per core
+  setLimit(PLN::getSystemLimit());   // Use the machine's memory limit
+  held = 0;                     // Initialize to no arenas mapped
+  tickets = admitted = 0;       // Initialize to no jobs waiting for memory
+  hugePages = false;            // Initialize to regular pages
+  closing = false;              // Initialize to accepting jobs
+  profile = NULL;               // Initialize to size table parameters
+  master = NULL;                // Initialize to no master instance
+}
+
+/********************************************************************************
+ * setThreads() initializes the count of threads running jobs.
+********************************************************************************/
+void SRV::setThreads(int count){
+  threads = max(count, 1);
+}
+
+/********************************************************************************
+ * setLimit() initializes the memory limit of all threads' arenas in bytes.
+********************************************************************************/
+void SRV::setLimit(size_t bound){
+  limit = bound;
+}
+
+/********************************************************************************
+ * setHugePages() sets whether each thread's arena is backed by transparent
+ * huge pages.
+********************************************************************************/
+void SRV::setHugePages(bool enable){
+  hugePages = enable;
+}
+
+/********************************************************************************
+ * setProfile() sets the profile that picks each job's GLS parameters.
+********************************************************************************/
+void SRV::setProfile(TUN *tuner){
+  profile = tuner;
+}
+
+/********************************************************************************
+ * setMaster() sets the master instance subset jobs pick their cities from.
+********************************************************************************/
+void SRV::setMaster(MST *instance){
+  master = instance;
+}
+
+/********************************************************************************
+ * runServer() starts the threads, then reads jobs from stdin if the path is
+ * "-", returning once every job is answered, or else listens on a Unix
+ * domain socket at the path and reads each connection on its own thread,
+ * running until the process is stopped.
+********************************************************************************/
+bool SRV::runServer(string path){
+  signal(SIGPIPE, SIG_IGN);                             // Report disconnected clients as write errors
+
+  vector<std::thread> pool;                             // Threads running jobs
+  for(int i = 0; i < threads; i++){                     // For each thread
+    pool.push_back(std::thread(&SRV::runWorker, this));   // Start thread
+  }
+
+  if(path == "-"){                                      // If jobs come from stdin
+    std::shared_ptr<Client> client(new Client);
+    client->out = STDOUT_FILENO;                          // Answer on stdout
+    client->owned = false;
+    readJobs(stdin, client);                              // Read jobs until end of input
+  }
+  else{                                                 // Else, jobs come from a socket
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)){          // If path does not fit in address
+      cout << "ERROR: SOCKET PATH TOO LONG" << endl;        // Print error message
+      path = "";
+    }
+    int listener = path.empty() ? -1 : socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener >= 0){                                    // If socket was created
+      path.copy(address.sun_path, path.size());
+      unlink(path.c_str());                                 // Remove socket left by a previous server
+      if(bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, 64) < 0){
+        close(listener);
+        listener = -1;
+      }
+    }
+    if(listener < 0){                                     // If socket cannot be served
+      cout << "ERROR: CANNOT LISTEN ON " << path << endl;   // Print error message
+    }
+    else{                                                 // Else
+      cout << "Listening on " << path << endl;
+      int connection;
+      while((connection = accept(listener, NULL, NULL)) >= 0){   // For each connecting client
+        std::shared_ptr<Client> client(new Client);
+        client->out = connection;                             // Answer on connection
+        client->owned = true;
+        FILE *in = fdopen(dup(connection), "r");              // Read from own descriptor
+        if(!in){
+          continue;
+        }
+        std::thread(&SRV::readJobs, this, in, client).detach();   // Read client's jobs on own thread
+      }
+      close(listener);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    closing = true;                                       // No more jobs will arrive
+  }
+  ready.notify_all();                                   // Wake threads to finish
+  for(int i = 0; i < threads; i++){                     // For each thread
+    pool[i].join();                                       // Wait for its jobs to finish
+  }
+  return path == "-";                                   // Socket server only returns on error
+}
+
+/********************************************************************************
+ * readJobs() reads jobs from a client until it disconnects, queueing each
+ * whole job and answering malformed ones with an error.
+********************************************************************************/
+void SRV::readJobs(FILE *in, std::shared_ptr<Client> client){
+  char command[64], name[64];                           // Hold command and job name
+  while(fscanf(in, "%63s", command) == 1){              // For each command
+    string word = command;
+    int count = 0;                                        // Count of cities in job
+    Job job;
+    job.seconds = 0;
+    bool subset = word == "subset";                       // Track if job picks master cities
+    if((word != "solve" && !subset) || fscanf(in, "%63s %d %lf", name, &count, &job.seconds) != 3){
+      client->answer("error - unknown command\n");          // Answer error
+      break;                                                // Stop reading, the stream is out of step
+    }
+    job.name = name;
+    if(count < 1 || !(job.seconds > 0)){                  // If job cannot be solved
+      client->answer("error " + job.name + " bad size or time\n");
+      if(!skipCities(in, count)){                           // Skip its cities, stop if they are cut short
+        break;
+      }
+      continue;
+    }
+    if(subset && !master){                                // If no master instance was read
+      client->answer("error " + job.name + " no master instance\n");
+      if(!skipCities(in, count)){                           // Skip its cities, stop if they are cut short
+        break;
+      }
+      continue;
+    }
+    if(getJobSize(count, subset) > limit){                // If its arena alone does not fit in memory
+      client->answer("error " + job.name + " too large for memory\n");
+      if(!skipCities(in, count)){                           // Skip its cities, stop if they are cut short
+        break;
+      }
+      continue;
+    }
+    bool complete = true;                                 // Track if every city was read
+    if(subset){                                           // If job picks master cities
+      job.ids.resize(count);
+      for(int i = 0; i < count && complete; i++){           // For each city
+        complete = fscanf(in, "%d", &job.ids[i]) == 1;
+      }
+    }
+    else{                                                 // Else, job gives coordinates
+      job.x.resize(count);
+      job.y.resize(count);
+      for(int i = 0; i < count && complete; i++){           // For each city
+        complete = fscanf(in, "%d %d", &job.x[i], &job.y[i]) == 2;
+      }
+    }
+    if(!complete){                                        // If job was cut short
+      client->answer("error " + job.name + " missing cities\n");
+      break;
+    }
+    job.client = client;
+    addJob(job);                                          // Queue job
+  }
+  fclose(in);                                           // Close reading descriptor
+}
+
+/********************************************************************************
+ * skipCities() reads past the rest of a refused job's command line and its
+ * count of city lines, so the client's next job is read in step. Returns
+ * false if the input ends first.
+********************************************************************************/
+bool SRV::skipCities(FILE *in, int count){
+  int c = 0;
+  for(int lines = 0; lines <= count; lines++){          // For the command line and each city line
+    while((c = getc(in)) != EOF && c != '\n');            // Read to end of line
+    if(c == EOF){                                         // If input ended
+      return lines == count;                                // Only the last line may lack a newline
+    }
+  }
+  return true;
+}
+
+/********************************************************************************
+ * addJob() queues a job behind its client's waiting jobs. A client with no
+ * waiting jobs joins the end of the turn order.
+********************************************************************************/
+void SRV::addJob(Job &job){
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    std::shared_ptr<Client> client = job.client;
+    if(client->jobs.empty()){                             // If client has no waiting jobs
+      turns.push_back(client);                              // Give client a turn
+    }
+    client->jobs.push_back(std::move(job));               // Queue job
+  }
+  ready.notify_one();                                   // Wake a thread
+}
+
+/********************************************************************************
+ * getJob() waits for a job and takes the first waiting job of the client
+ * whose turn it is. A client with more waiting jobs goes to the end of the
+ * turn order. If the job needs a larger arena than the thread holds, the
+ * thread gives up its arena and waits, in the order jobs began waiting,
+ * until the new arena fits the memory limit. While a job waits, threads
+ * give up their arenas instead of keeping them for their next job. Returns
+ * false once the server is closing and no job waits.
+********************************************************************************/
+bool SRV::getJob(Job &job, GLS &obj, size_t &mine){
+  std::unique_lock<std::mutex> guard(lock);
+  if(mine > 0 && tickets > admitted){                   // If thread holds an arena another job waits for
+    releaseArena(obj, mine);                              // Give it up
+  }
+  ready.wait(guard, [this, &obj, &mine]{
+    if(mine > 0 && tickets > admitted){                   // If an idle thread's arena is wanted
+      releaseArena(obj, mine);                              // Give it up
+    }
+    return closing || !turns.empty();
+  });
+  if(turns.empty()){                                    // If server is closing and no job waits
+    return false;
+  }
+  std::shared_ptr<Client> client = turns.front();       // Client whose turn it is
+  turns.pop_front();
+  job = std::move(client->jobs.front());                // Take its first job
+  client->jobs.pop_front();
+  if(!client->jobs.empty()){                            // If client has more waiting jobs
+    turns.push_back(client);                              // Client waits for its next turn
+  }
+
+  bool subset = !job.ids.empty();                       // Track if job picks master cities
+  size_t need = getJobSize(subset ? job.ids.size() : job.x.size(), subset);   // Bytes of job's arena
+  if(need > mine){                                      // If thread's arena is too small
+    releaseArena(obj, mine);                              // Give it up
+    long ticket = tickets++;                              // Wait behind jobs waiting already
+    ready.notify_all();                                   // Ask idle threads for their arenas
+    ready.wait(guard, [this, ticket, need]{ return ticket == admitted && held + need <= limit; });
+    admitted++;
+    held += need;                                         // Count new arena
+    mine = need;
+    ready.notify_all();                                   // Wake next waiting job
+  }
+  return true;
+}
+
+/********************************************************************************
+ * getJobSize() returns the bytes of the arena of a job of a count of cities,
+ * with the Christofides tour built for a large job that does not start from
+ * the master's order. Jobs solved exactly take no arena.
+********************************************************************************/
+size_t SRV::getJobSize(int count, bool subset){
+  if(count <= EXACT_SIZE){                              // If job is solved exactly
+    return 0;
+  }
+  size_t bytes = PLN::getSolverSize(count, false, 1, false);
+  if(!subset && count > CHRISTOFIDES_SIZE){             // If job starts from a Christofides tour
+    bytes += PLN::getChristofidesSize(count);
+  }
+  return bytes;
+}
+
+/********************************************************************************
+ * releaseArena() unmaps a thread's arena, once no background tour reads it,
+ * and wakes jobs waiting for memory. Called with the server lock held.
+********************************************************************************/
+void SRV::releaseArena(GLS &obj, size_t &mine){
+  obj.waitPending();                                    // Let a background tour stop reading the arena
+  obj.arena.release();                                  // Unmap arena
+  held -= mine;
+  mine = 0;
+  ready.notify_all();                                   // Wake jobs waiting for memory
+}
+
+/********************************************************************************
+ * runWorker() keeps one GLS object, and so one arena, for all jobs the
+ * thread runs, so memory is only mapped again for a larger job, or after
+ * the arena was given up to a job waiting for memory.
+********************************************************************************/
+void SRV::runWorker(){
+  GLS obj;                                              // Thread's algorithm object
+  obj.setHugePages(hugePages);                          // Set page size of arena
+  size_t mine = 0;                                      // Bytes of arena counted for thread
+  Job job;
+  while(getJob(job, obj, mine)){                        // While jobs arrive
+    solveJob(obj, job);                                   // Solve job
+    job.client.reset();                                   // Let client close once answered
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  releaseArena(obj, mine);                              // Return thread's memory
+}
+
+/********************************************************************************
+ * solveJob() runs GLS on a job's cities within its time limit and answers
+ * the client with the best tour. Jobs of at most EXACT_SIZE cities are
+ * solved exactly instead. A subset job's cities are gathered from the master
+ * instance, GLS starts from their order along the master's Hilbert curve,
+ * and the tour is answered with master IDs.
+********************************************************************************/
+void SRV::solveJob(GLS &obj, Job &job){
+  vector<int> start;                                    // First tour of a subset job
+  if(!job.ids.empty() && !master->getSubset(job.ids, job.x, job.y, start)){   // If a subset city is unknown
+    job.client->answer("error " + job.name + " bad city\n");
+    return;
+  }
+  int count = job.x.size();                             // Count of cities in job
+  vector<int> tour(count);                              // Best tour
+  int cost = 0;                                         // Best tour distance
+
+  if(count <= EXACT_SIZE){                              // If job is small enough to solve exactly
+    EXA exact;                                            // Create an exact object
+    exact.setMaxTime(job.seconds);                        // Set job's time limit
+    exact.TSP::setProblem(job.x.data(), job.y.data(), count);
+    exact.initialize();                                   // Create first tour
+    exact.solve();                                        // Solve job
+    cost = exact.bestCost;
+    tour.assign(exact.best, exact.best + count);
+  }
+  else{                                                 // Else, search with GLS
+    obj.setMaxTime(job.seconds);                          // Set job's time limit
+    if(!obj.TSP::setProblem(job.x.data(), job.y.data(), count)){   // If job does not fit in memory
+      job.client->answer("error " + job.name + " out of memory\n");
+      return;
+    }
+    if(start.empty()){                                    // If job has no first tour
+      obj.initialize();                                     // Initialize dynamic arrays
+    }
+    else{                                                 // Else, start from master's order
+      std::copy(start.begin(), start.end(), obj.tour);
+      obj.tourCost = obj.getTourCost(obj.tour);
+      obj.setBest();
+      obj.initializeSearch();                               // Create GLS arrays for first tour
+    }
+    if(profile){                                          // If a profile is set
+      profile->setParameters(obj);                          // Apply its parameters
+    }
+    obj.search();                                         // Run the algorithm
+    cost = obj.bestCost;
+    tour.assign(obj.best, obj.best + count);
+  }
+
+  string line = "tour " + job.name + " " + std::to_string(cost);   // Build answer
+  for(int i = 0; i < count; i++){                       // For each city in best tour
+    line += " " + std::to_string(job.ids.empty() ? tour[i] : job.ids[tour[i]]);
+  }
+  line += "\n";
+  job.client->answer(line);                             // Answer client
+}
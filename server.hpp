@@ -0,0 +1,101 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The SRV class keeps the solver running as a server, so many
+ *              small jobs avoid starting a process and reading and writing
+ *              files each. Clients connect to a Unix domain socket, or use
+ *              stdin and stdout, and send jobs in a line protocol:
+ *
+ *                solve [job] [n] [seconds]      followed by n lines "x y"
+ *                subset [job] [n] [seconds]     followed by n master city IDs
+ *
+ *              The server answers each job, in the order they finish, with
+ *
+ *                tour [job] [cost] [city] ... [city]
+ *                error [job] [message]
+ *
+ *              Jobs are run by a pool of threads, each keeping one GLS object
+ *              whose arena is reused from job to job. A job's arena is only
+ *              mapped once the arenas of all threads fit the memory limit
+ *              with it; until then the job waits, and the other threads give
+ *              up their arenas as they finish. A job whose arena alone does
+ *              not fit is answered with an error. Waiting jobs are taken
+ *              from the clients in turn, so one client sending many jobs does
+ *              not hold up the others. Subset jobs pick their cities from a
+ *              master instance read once when the server starts, start from
+ *              the master's Hilbert curve order, and are answered with
+ *              master city IDs.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "gls.hpp"
+#include "master.hpp"
+#include "tuning.hpp"
+
+using std::vector;
+
+struct Client;
+
+struct Job{
+	string name;                     // Job name given by client, echoed in answer
+	double seconds;                  // Time limit
+	vector<int> x;                   // Cities' x values
+	vector<int> y;                   // Cities' y values
+	vector<int> ids;                 // Master IDs of a subset job's cities, or empty
+	std::shared_ptr<Client> client;  // Client to answer
+};
+
+struct Client{
+	int out;                         // File descriptor answers are written to
+	bool owned;                      // Close descriptor when client is deleted
+	std::mutex lock;                 // Keeps answers of different jobs whole
+	std::deque<Job> jobs;            // Jobs waiting for a thread, guarded by server lock
+
+	~Client();                                 // Deconstructor
+	void answer(const string&);                // Write one answer line
+};
+
+class SRV{
+  public:
+	int threads;             // Count of threads running jobs
+	size_t limit;            // Memory limit of all threads' arenas, in bytes
+	size_t held;             // Bytes of arenas mapped by threads
+	long tickets;            // Count of jobs that have waited for memory
+	long admitted;           // Count of waiting jobs given their memory
+	bool hugePages;          // Back arenas with transparent huge pages
+	bool closing;            // No more jobs will arrive
+	TUN *profile;            // Parameters of jobs, or NULL for size tables
+	MST *master;             // Master instance of subset jobs, or NULL
+
+	std::mutex lock;                                // Guards waiting jobs and closing
+	std::condition_variable ready;                  // Signals a waiting job or closing
+	std::deque<std::shared_ptr<Client>> turns;      // Clients with waiting jobs, in turn order
+
+  public:
+	SRV();                                     // Constructor
+
+	void setThreads(int);                      // Set count of threads running jobs
+	void setLimit(size_t);                     // Set memory limit in bytes
+	void setHugePages(bool);                   // Set whether arenas use huge pages
+	void setProfile(TUN*);                     // Set profile picking parameters of jobs
+	void setMaster(MST*);                      // Set master instance of subset jobs
+
+	bool runServer(string);                    // Serve a socket path, or "-" for stdin
+	void readJobs(FILE*, std::shared_ptr<Client>);   // Read jobs from one client
+	bool skipCities(FILE*, int);               // Read past a refused job's cities
+	void addJob(Job&);                         // Queue job behind its client's jobs
+	bool getJob(Job&, GLS&, size_t&);          // Take next job, from clients in turn, and its memory
+	size_t getJobSize(int, bool);              // Get bytes of a job's arena
+	void releaseArena(GLS&, size_t&);          // Unmap a thread's arena
+	void runWorker();                          // Run jobs until server closes
+	void solveJob(GLS&, Job&);                 // Solve one job and answer its client
+};
+#endif
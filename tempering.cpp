@@ -0,0 +1,241 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the PTE class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+ *   Swendsen, Wang, "Replica Monte Carlo simulation of spin glasses",
+ *   Physical Review Letters 57, 1986
+ *   Kirkpatrick, Gelatt, Vecchi, "Optimization by simulated annealing",
+ *   Science 220, 1983
+********************************************************************************/
+#include <algorithm>
+#include <thread>
+#include "tempering.hpp"
+
+#define NEAREST_COUNT 10           // Nearest cities a move may join a city to
+#define MIN_SWEEP_MOVES 20000      // Fewest moves tried by a replica between exchanges
+#define COLD_TEMPERATURE 0.02      // Coldest temperature, as a share of the mean edge
+#define HOT_TEMPERATURE 0.15       // Hottest temperature, as a share of the mean edge
+#define MIN_REPLICAS 4             // Fewest replicas given by default
+#define POLISH_SHARE 0.95          // Share of time limit after which the best tour is polished
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+PTE::PTE(){
+  setReplicas(max((int)std::thread::hardware_concurrency(), MIN_REPLICAS));   // Use one replica per core, at least 4
+  polished = false;             // Initialize to unpolished
+  exchanges = 0;                // Initialize count of exchanges to 0
+}
+
+/********************************************************************************
+ * Deconstructor deletes the replicas, which share this object's distances.
+********************************************************************************/
+PTE::~PTE(){
+  for(unsigned i = 0; i < ladder.size(); i++){   // For each replica
+    delete ladder[i];                              // Delete replica
+  }
+}
+
+/********************************************************************************
+ * setReplicas() initializes the count of replicas. At least two are needed
+ * to exchange.
+********************************************************************************/
+void PTE::setReplicas(int count){
+  replicas = max(count, 2);
+}
+
+/********************************************************************************
+ * initialize() starts every replica from a Hilbert curve tour and spaces the
+ * temperatures geometrically between shares of the Hilbert tour's mean edge.
+********************************************************************************/
+void PTE::initialize(){
+  setHilbertTour(tour);                                // Start from a tour along a Hilbert curve
+  tourCost = getTourCost(tour);                        // Get the cost of the tour
+  setBest();                                           // Set the best tour as current tour
+  setGlsIterations(INT_MAX);                           // Run rounds until time limit
+  setNearest();                                        // Find cities moves may join
+
+  for(int i = 0; i < replicas; i++){                   // For each rung
+    RPL *replica = new RPL;                              // Create replica
+    replica->setHugePages(hugePages);
+    replica->TSP::setProblem(*this);                     // Share cities and distances
+    std::copy(tour, tour + size, replica->tour);         // Start from Hilbert tour
+    replica->tourCost = tourCost;
+    replica->setBest();
+    replica->setPositions();
+    ladder.push_back(replica);
+    generators.push_back(std::mt19937(generator()));     // Seed its random numbers
+  }
+
+  double edge = (double)tourCost/size;                 // Mean edge of Hilbert tour
+  for(int i = 0; i < replicas; i++){                   // For each rung, coldest first
+    temperature.push_back(edge*COLD_TEMPERATURE*
+                          pow(HOT_TEMPERATURE/COLD_TEMPERATURE, (double)i/(replicas - 1)));
+  }
+}
+
+/********************************************************************************
+ * runAlgorithm() runs rounds until the time limit, writes the best tour, and
+ * prints the count of replicas and exchanges.
+********************************************************************************/
+void PTE::runAlgorithm(){
+  TSP::runAlgorithm();                                 // Search and write results
+  cout << "Replicas: " << replicas << "    Exchanges: " << exchanges << endl;
+}
+
+/********************************************************************************
+ * setNearest() records the nearest cities of each city, filling blocks of
+ * cities on several threads.
+********************************************************************************/
+void PTE::setNearest(){
+  int count = min(NEAREST_COUNT, size - 1);            // Nearest cities per city
+  nearest.assign((size_t)size*count, 0);
+  forRows(size, [this, count](int first, int last){
+    vector<int> others(size);
+    for(int c = first; c < last; c++){                   // For each city
+      for(int i = 0; i < size; i++){
+        others[i] = i;
+      }
+      std::swap(others[c], others[size - 1]);              // Leave city out
+      std::partial_sort(others.begin(), others.begin() + count, others.end() - 1,
+                        [this, c](int a, int b){ return distance[c][a] < distance[c][b]; });
+      std::copy(others.begin(), others.begin() + count, nearest.begin() + (size_t)c*count);
+    }
+  });
+}
+
+/********************************************************************************
+ * guidedLocalSearch() runs one round: a sweep of every replica on its own
+ * thread, then an exchange between rungs, recording the best tour of any
+ * replica. Near the end of the time limit the best tour is polished instead,
+ * ending the search.
+********************************************************************************/
+void PTE::guidedLocalSearch(){
+  if(getDuration() >= POLISH_SHARE*maxTime){           // If time to polish has come
+    polish();                                            // Polish best tour
+    maxGLS = iteration;                                  // End search
+    return;
+  }
+
+  vector<std::thread> pool;                            // Sweeping threads
+  for(int i = 0; i < replicas; i++){                   // For each rung
+    pool.push_back(std::thread(&PTE::sweep, this, i));   // Sweep its replica
+  }
+  for(int i = 0; i < replicas; i++){
+    pool[i].join();
+  }
+  exchange();                                          // Trade replicas between rungs
+
+  for(int i = 0; i < replicas; i++){                   // For each replica
+    if(ladder[i]->bestCost < bestCost){                  // If it found the best tour
+      std::copy(ladder[i]->best, ladder[i]->best + size, best);
+      bestCost = ladder[i]->bestCost;
+    }
+  }
+}
+
+/********************************************************************************
+ * sweep() tries moves on one rung's replica at its temperature. A move picks
+ * a random city and one of its nearest cities, and evaluates the 2-opt swap
+ * joining them by its change in distance. A swap is made if it shortens the tour,
+ * or else with probability exp(-change/temperature). The replica's best tour
+ * is recorded at the end of the sweep.
+********************************************************************************/
+void PTE::sweep(int rung){
+  RPL *replica = ladder[rung];
+  std::mt19937 &generator = generators[rung];
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  int count = nearest.size()/size;                     // Nearest cities per city
+  int moves = max(size, MIN_SWEEP_MOVES);              // Moves per sweep
+  double cool = 1/temperature[rung];                   // Inverse temperature
+
+  for(int m = 0; m < moves; m++){                      // For each move
+    int city = generator() % size;                       // Pick city
+    int other = nearest[(size_t)city*count + generator() % count];   // Pick one of its nearest cities
+    int c1 = replica->pos[city], c2 = replica->pos[other];           // Their tour positions
+    if(replica->getNext(c1) == c2 || replica->getNext(c2) == c1){    // If they are already joined
+      continue;
+    }
+    int change = replica->getSwapCost(c1, c2);           // Change of joining them
+    if(change <= 0 || chance(generator) < exp(-change*cool)){   // If move is accepted
+      replica->twoOptSwap(c1, c2, replica->tour);          // Make it
+      replica->tourCost += change;
+    }
+  }
+  if(replica->tourCost < replica->bestCost){           // If replica holds its best tour
+    replica->setBest();                                  // Record it
+  }
+}
+
+/********************************************************************************
+ * exchange() offers each pair of neighboring rungs, starting from the first
+ * or second rung in turn, a trade of replicas. A pair trades with
+ * probability min(1, exp((1/T1 - 1/T2)(E1 - E2))), so a colder rung always
+ * takes a better replica from a hotter one.
+********************************************************************************/
+void PTE::exchange(){
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  for(int i = iteration % 2; i + 1 < replicas; i += 2){   // For each pair of rungs
+    double gain = (1/temperature[i] - 1/temperature[i+1])*
+                  (ladder[i]->tourCost - ladder[i+1]->tourCost);
+    if(gain >= 0 || chance(generators[i]) < exp(gain)){       // If trade is accepted
+      std::swap(ladder[i], ladder[i+1]);                    // Trade replicas
+      exchanges++;
+    }
+  }
+}
+
+/********************************************************************************
+ * polish() runs a fast local search of a GLS object sharing the distances
+ * from the best tour, which makes every improving 2-opt swap at zero
+ * penalties, and records the result. Its edge store is only created here.
+********************************************************************************/
+void PTE::polish(){
+  GLS polisher;                                        // Search object for best tour
+  polisher.setHugePages(hugePages);
+  polisher.TSP::setProblem(*this);                     // Share cities and distances
+  polisher.setMaxTime(maxTime);
+  polisher.setGlsIterations(INT_MAX);
+  std::copy(best, best + size, polisher.tour);         // Start from best tour
+  polisher.tourCost = bestCost;
+  polisher.setBest();
+  polisher.initializeSearch();                         // Create GLS arrays with zero penalties
+  polisher.fastLocalSearch();                          // Descend to local optimum
+  if(polisher.bestCost < bestCost){                    // If polished tour is better
+    std::copy(polisher.best, polisher.best + size, best);
+    bestCost = polisher.bestCost;
+  }
+  polished = true;
+}
+
+/********************************************************************************
+ * getArenaSize() adds the bytes of the tour positions to the TSP class's
+ * arrays.
+********************************************************************************/
+size_t RPL::getArenaSize(){
+  return TSP::getArenaSize() + Arena::align(size*sizeof(int));
+}
+
+/********************************************************************************
+ * setPositions() creates the positions of the cities in the current tour,
+ * which 2-opt swaps keep up to date.
+********************************************************************************/
+void RPL::setPositions(){
+  pos = arena.allocate<int>(size);
+  for(int i = 0; i < size; i++){                       // For each place in the tour
+    pos[tour[i]] = i;                                    // Record city's position
+  }
+}
+
+/********************************************************************************
+ * getSwapCost() returns the change in distance of the 2-opt swap that joins
+ * the cities at two tour positions, and their next cities.
+********************************************************************************/
+int RPL::getSwapCost(int c1, int c2){
+  int a = tour[c1], b = tour[c2];                      // City1 and city2
+  int an = tour[getNext(c1)], bn = tour[getNext(c2)];  // Their next neighbors
+  return distance[a][b] + distance[an][bn] - distance[a][an] - distance[b][bn];
+}
@@ -0,0 +1,62 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The PTE class runs parallel tempering: replicas of the tour
+ *              are annealed at a ladder of fixed temperatures on separate
+ *              threads, and after each sweep neighboring temperatures trade
+ *              replicas under the Metropolis criterion, so a hot replica
+ *              that found a good region can cool down, and a stuck cold one
+ *              can heat up. Each replica is an RPL object sharing this
+ *              object's distances, moved by GLS's 2-opt swap: a move joins a
+ *              random city to one of its nearest cities, and is priced by
+ *              distance alone, so a replica has no edge store. The best tour
+ *              is polished at the end of the time limit by a fast local
+ *              search of one GLS object, the only one with an edge store.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef TEMPERING_HPP
+#define TEMPERING_HPP
+
+#include <random>
+#include <vector>
+#include "gls.hpp"
+
+using std::vector;
+
+/********************************************************************************
+ * RPL is one replica of the tour: a GLS object whose only search array is its
+ * tour positions, and whose swap cost is the change in distance.
+********************************************************************************/
+class RPL: public GLS{
+  public:
+	size_t getArenaSize();                     // Get bytes of tours and positions
+	void setPositions();                       // Create positions of current tour
+	int getSwapCost(int, int);                 // Get distance change of a 2-opt swap
+};
+
+class PTE: public TSP{
+  public:
+	int replicas;            // Count of replicas
+	bool polished;           // Best tour was polished at the end
+	int exchanges;           // Count of accepted replica exchanges
+
+	vector<RPL*> ladder;     // Replica at each temperature, coldest first
+	vector<double> temperature;   // Temperature of each rung, coldest first
+	vector<std::mt19937> generators;   // Random number generator of each rung
+	vector<int> nearest;     // Nearest cities of each city
+
+  public:
+	PTE();                                     // Constructor
+	~PTE();                                    // Deconstructor
+
+	void setReplicas(int);                     // Set count of replicas
+
+	void initialize();                         // Create replicas and temperature ladder
+	void runAlgorithm();                       // Run the algorithm and print exchanges
+	void setNearest();                         // Find nearest cities of each city
+	void guidedLocalSearch();                  // Run one sweep per replica, then exchange
+	void sweep(int);                           // Anneal one rung's replica for one sweep
+	void exchange();                           // Trade replicas between neighboring rungs
+	void polish();                             // Descend from the best tour to a local optimum
+};
+#endif
@@ -0,0 +1,113 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: Regression check of the exact engine. Uniform and clustered
+ *              instances of 5 to 22 cities are solved by the EXA class and by
+ *              a plain reference Held-Karp dynamic program written apart from
+ *              it, and the tour costs must match. Each EXA tour must also
+ *              visit every city once and cost what it claims. Run by
+ *              "make check".
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include "../exact.hpp"
+
+/********************************************************************************
+ * referenceCost() returns the optimal tour cost of the cities by the
+ * textbook Held-Karp recurrence over subsets of cities 1..n-1, with no
+ * padding, vector instructions or bounds.
+********************************************************************************/
+static long referenceCost(const vector<int> &xs, const vector<int> &ys){
+  int n = xs.size(), m = n - 1;
+  vector<vector<int> > d(n, vector<int>(n));
+  for(int i = 0; i < n; i++){
+    for(int j = 0; j < n; j++){
+      d[i][j] = TSP::getDistance(xs[i], ys[i], xs[j], ys[j]);
+    }
+  }
+  const long NONE = LONG_MAX / 4;
+  vector<long> cost(((size_t)1 << m) * m, NONE);        // Cheapest path from 0 through a subset ending at a city
+  for(int k = 0; k < m; k++){
+    cost[((size_t)1 << k) * m + k] = d[0][k+1];
+  }
+  for(size_t subset = 1; subset < ((size_t)1 << m); subset++){
+    for(int k = 0; k < m; k++){
+      long here = cost[subset * m + k];
+      if(!(subset & ((size_t)1 << k)) || here >= NONE){
+        continue;
+      }
+      for(int j = 0; j < m; j++){                         // Extend path to each city not in subset
+        if(!(subset & ((size_t)1 << j))){
+          size_t next = (subset | ((size_t)1 << j)) * m + j;
+          cost[next] = min(cost[next], here + d[k+1][j+1]);
+        }
+      }
+    }
+  }
+  long best = NONE;
+  size_t full = ((size_t)1 << m) - 1;
+  for(int k = 0; k < m; k++){
+    best = min(best, cost[full * m + k] + d[k+1][0]);
+  }
+  return best;
+}
+
+/********************************************************************************
+ * makeCities() fills an instance of a count of cities, spread uniformly, or
+ * in three tight clusters far apart.
+********************************************************************************/
+static void makeCities(int count, bool clustered, vector<int> &xs, vector<int> &ys){
+  xs.clear();
+  ys.clear();
+  for(int i = 0; i < count; i++){
+    if(clustered){
+      int c = i % 3;
+      xs.push_back(c * 5000 + rand() % 40);
+      ys.push_back((c == 1) * 4000 + rand() % 40);
+    }
+    else{
+      xs.push_back(rand() % 1000);
+      ys.push_back(rand() % 1000);
+    }
+  }
+}
+
+/********************************************************************************
+ * main() solves each instance both ways and prints a line for each mismatch.
+ * Returns 1 if any instance failed.
+********************************************************************************/
+int main(){
+  srand(7);
+  const int sizes[] = {5, 8, 12, 16, 17, 19, 20, 21, 22};
+  int failed = 0, checked = 0;
+  for(int size : sizes){
+    for(int clustered = 0; clustered < 2; clustered++){
+      vector<int> xs, ys;
+      makeCities(size, clustered, xs, ys);
+      EXA obj;
+      obj.setMaxTime(4);
+      obj.TSP::setProblem(xs.data(), ys.data(), size);
+      obj.initialize();
+      obj.solve();
+
+      long expected = referenceCost(xs, ys);
+      vector<int> tour(obj.best, obj.best + size);
+      std::sort(tour.begin(), tour.end());
+      bool permutation = true;
+      for(int i = 0; i < size; i++){
+        permutation = permutation && tour[i] == i;
+      }
+      checked++;
+      if(!permutation || obj.getTourCost(obj.best) != obj.bestCost || obj.bestCost != expected){
+        cout << "FAILED: " << size << (clustered ? " clustered" : " uniform") << " cities, exact "
+             << obj.bestCost << (obj.proven ? " proven" : " unproven") << ", reference " << expected << endl;
+        failed++;
+      }
+    }
+  }
+  if(failed){
+    return 1;
+  }
+  cout << "exact: " << checked << " instances match the reference" << endl;
+  return 0;
+}
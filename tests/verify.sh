@@ -0,0 +1,60 @@
+#!/bin/sh
+################################################################################
+# Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+# Date: 06/08/2018
+# Description: Batch cases for tsp-verify. Each case writes small instance and
+#              tour files, runs the verifier on them, and checks its exit code
+#              and the PASS or FAIL line it prints. Run by "make check".
+# Sources: see main.cpp header for program sources
+################################################################################
+VERIFY=${VERIFY:-./tsp-verify}
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+FAILED=0
+
+################################################################################
+# expect() runs the verifier with the given arguments and fails the case if
+# the exit code differs from the first argument or the output does not hold
+# the second.
+################################################################################
+expect(){
+  code=$1
+  text=$2
+  shift 2
+  out=$("$VERIFY" "$@" 2>&1)
+  got=$?
+  if [ "$got" -ne "$code" ] || ! printf '%s\n' "$out" | grep -q -- "$text"; then
+    echo "FAILED: tsp-verify $* exited $got, expected $code and \"$text\":"
+    printf '%s\n' "$out"
+    FAILED=1
+  fi
+}
+
+# A 3 by 4 rectangle, whose tour around it costs 14
+printf '0 0 0\n1 3 0\n2 3 4\n3 0 4\n' > "$DIR/rect.txt"
+printf '14\n0\n1\n2\n3\n' > "$DIR/rect.tour"
+
+# The rectangle with its third line broken, and the tour of the cities before it
+printf '0 0 0\n1 3 0\n2 3 x\n3 0 4\n' > "$DIR/broken.txt"
+printf '6\n0\n1\n' > "$DIR/broken.tour"
+
+printf '%s %s\n%s %s\n' "$DIR/rect.txt" "$DIR/rect.tour" \
+                        "$DIR/broken.txt" "$DIR/broken.tour" > "$DIR/malformed.list"
+expect 2 "FAIL $DIR/broken.txt $DIR/broken.tour: cannot read instance, bad line 3" -b "$DIR/malformed.list"
+expect 2 "PASS $DIR/rect.txt $DIR/rect.tour 14" -b "$DIR/malformed.list"
+
+# Exit codes: 0 when every tour passes, 1 when a tour is wrong, 2 when a file
+# cannot be read or the arguments are wrong
+printf '13\n0\n1\n2\n3\n' > "$DIR/cost.tour"
+printf '14\n0\n1\n1\n3\n' > "$DIR/twice.tour"
+expect 0 "PASS $DIR/rect.txt $DIR/rect.tour 14" "$DIR/rect.txt" "$DIR/rect.tour"
+expect 1 "FAIL $DIR/rect.txt $DIR/cost.tour" "$DIR/rect.txt" "$DIR/cost.tour"
+expect 1 "FAIL $DIR/rect.txt $DIR/twice.tour" "$DIR/rect.txt" "$DIR/twice.tour"
+expect 1 "PASS $DIR/rect.txt $DIR/rect.tour 14" "$DIR/rect.txt" "$DIR/rect.tour" "$DIR/rect.txt" "$DIR/cost.tour"
+expect 2 "FAIL $DIR/rect.txt $DIR/missing.tour" "$DIR/rect.txt" "$DIR/missing.tour"
+expect 2 "Usage" "$DIR/rect.txt"
+
+if [ "$FAILED" -ne 0 ]; then
+  exit 1
+fi
+echo "verify: all cases passed"
@@ -0,0 +1,232 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the TRC class. Here, you
+ *              can find the initializations of class variables and definitions
+ *              of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <cstring>
+#include "gls.hpp"
+#include "trace.hpp"
+
+#define TRACE_BUFFER 65536         // Events written or read at once
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+TRC::TRC(){
+  file = NULL;                  // Initialize to no file
+  replaying = false;            // Initialize to recording
+  recording = false;            // Initialize to no events written
+  diverged = false;             // Initialize to matching replay
+  memset(&header, 0, sizeof(header));
+  buffer.resize(TRACE_BUFFER);
+  used = filled = 0;            // Initialize buffer to empty
+  events = begun = 0;           // Initialize counts to 0
+  moves = penalties = 0;
+}
+
+/********************************************************************************
+ * Deconstructor closes the trace file.
+********************************************************************************/
+TRC::~TRC(){
+  if(file){                     // If a file is open
+    fclose(file);                 // Close it
+  }
+}
+
+/********************************************************************************
+ * record() takes a Christofides tour still being built, so the trajectory
+ * does not depend on when it finishes, restarts the search from the current
+ * tour, and writes the header and start tour. From then on the search logs
+ * its events here. Returns false if the file cannot be written.
+********************************************************************************/
+bool TRC::record(GLS &obj, string path, unsigned seed){
+  file = fopen(path.c_str(), "wb");
+  if(!file){                                            // If file cannot be created
+    cout << "ERROR: CANNOT WRITE " << path << endl;       // Print error message
+    return false;
+  }
+  if(obj.pending.valid()){                              // If a Christofides tour is being built
+    obj.pending.wait();                                   // Wait for it
+    obj.takePendingTour();                                // Take it if it is better
+  }
+  obj.setStartTour(obj.tour);                           // Restart search from current tour
+  obj.setBest();                                        // Make it the best tour, as a replay does
+
+  memcpy(header.magic, "GLSTRACE", 8);
+  header.size = obj.size;
+  header.seed = seed;
+  header.maxFLS = obj.maxFLS;
+  header.renumber = obj.renumber;
+  header.alpha = obj.alpha;
+  fwrite(&header, sizeof(header), 1, file);             // Write header, counts are filled in later
+  fwrite(obj.tour, sizeof(int), obj.size, file);        // Write start tour
+  recording = true;
+  obj.trace = this;                                     // Log search's events
+  return true;
+}
+
+/********************************************************************************
+ * stop() stops recording when the time limit cut an iteration short, since
+ * a replay without a time limit would run it to the end. The iteration is
+ * not counted.
+********************************************************************************/
+void TRC::stop(){
+  if(recording){                                        // If events are still written
+    recording = false;
+    begun--;                                              // Do not count cut iteration
+  }
+}
+
+/********************************************************************************
+ * finish() writes the buffered events and fills in the header's counts.
+ * Returns false if the file could not be written.
+********************************************************************************/
+bool TRC::finish(){
+  if(!file || replaying){                               // If nothing was recorded
+    return true;
+  }
+  recording = false;
+  fwrite(buffer.data(), sizeof(Event), used, file);     // Write remaining events
+  header.iterations = begun;
+  header.events = events;
+  fseek(file, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, file);             // Write header with counts
+  bool written = !ferror(file);
+  fclose(file);
+  file = NULL;
+  cout << "Trace: " << header.iterations << " iterations, " << header.events << " events" << endl;
+  return written;
+}
+
+/********************************************************************************
+ * open() reads the header and start tour of a trace file for a replay.
+ * Returns false if the file cannot be read or is not a trace.
+********************************************************************************/
+bool TRC::open(string path){
+  file = fopen(path.c_str(), "rb");
+  if(!file || fread(&header, sizeof(header), 1, file) != 1 ||   // If header cannot be read
+     memcmp(header.magic, "GLSTRACE", 8) != 0 || header.size < 1){
+    cout << "ERROR: CANNOT READ TRACE " << path << endl;  // Print error message
+    return false;
+  }
+  start.resize(header.size);
+  if(fread(start.data(), sizeof(int), header.size, file) != (size_t)header.size){
+    cout << "ERROR: CANNOT READ TRACE " << path << endl;
+    return false;
+  }
+  replaying = true;
+  return true;
+}
+
+/********************************************************************************
+ * replay() rebuilds the recorded search state on a GLS object whose cities
+ * have been read, and runs the recorded iterations as guidedLocalSearch()
+ * does, without a time limit, checking each event against the file. The
+ * times of fastLocalSearch() and updatePenalties() are summed and printed.
+ * Returns false if the replay diverged from the file.
+********************************************************************************/
+bool TRC::replay(GLS &obj){
+  if(obj.size != header.size){                          // If file does not match the problem
+    cout << "ERROR: TRACE IS FOR " << header.size << " CITIES" << endl;
+    return false;
+  }
+  std::copy(start.begin(), start.end(), obj.tour);      // Start from recorded tour
+  obj.tourCost = obj.getTourCost(obj.tour);
+  obj.setBest();
+  obj.initializeSearch();                               // Create GLS arrays
+  obj.setAlpha(header.alpha);                           // Use recorded parameters
+  obj.setFlsIterations(header.maxFLS);
+  obj.setStartTour(start.data());                       // Restart search as recording did
+  obj.setMaxTime(INT_MAX);                              // Run every recorded iteration
+  obj.setGlsIterations(INT_MAX);
+  obj.trace = this;                                     // Check search's events
+
+  double searching = 0, penalizing = 0;                 // Seconds in FLS and in penalty updates
+  long done = 0;                                        // Iterations replayed
+  int iteration = 0;                                    // Recorded number of iteration
+  for(; done < header.iterations && !diverged; done++){   // For each recorded iteration
+    if(used == filled && !refill()){                      // If file has no more events
+      diverged = true;
+      break;
+    }
+    const Event &event = buffer[used++];                  // Event starting iteration
+    events++;
+    if(event.a != TRACE_ITERATION){                       // If iteration ended elsewhere in recording
+      diverged = true;
+      break;
+    }
+    iteration = obj.iteration = event.b;                  // Continue from recorded iteration
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    obj.fastLocalSearch();                                // Call FLS to run
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    if(obj.iteration == obj.maxFLS){                      // If FLS has reached its limit of iterations
+      obj.setPenalties();                                   // Reset the tour penalties
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    obj.updatePenalties();                                // Update the penalties for the current best tour
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+    searching += std::chrono::duration<double>(t1 - t0).count();
+    penalizing += std::chrono::duration<double>(t3 - t2).count();
+  }
+  obj.trace = NULL;
+
+  cout << "Replay: " << done << " iterations, " << moves << " moves, " << penalties << " penalties    "
+          "FLS(sec): " << searching << "    Penalties(sec): " << penalizing << "    "
+          "Best Tour: " << obj.bestCost << endl;
+  if(diverged){                                         // If search left the recorded trajectory
+    cout << "ERROR: REPLAY DIVERGED IN ITERATION " << iteration << " AT EVENT " << events << endl;
+    return false;
+  }
+  return true;
+}
+
+/********************************************************************************
+ * refill() reads the next block of events of the file. Returns false if
+ * there are none.
+********************************************************************************/
+bool TRC::refill(){
+  filled = fread(buffer.data(), sizeof(Event), buffer.size(), file);
+  used = 0;
+  return filled > 0;
+}
+
+/********************************************************************************
+ * log() writes an event while recording, or checks it against the next
+ * event of the file while replaying, and counts moves and penalties.
+ * Returns false once a replay has diverged.
+********************************************************************************/
+bool TRC::log(int a, int b){
+  if(a >= 0){                                           // If event is a move
+    moves++;
+  }
+  else if(a != TRACE_ITERATION && a != TRACE_RESET){    // Else, if it is a penalty
+    penalties++;
+  }
+
+  if(!replaying){                                       // If recording
+    if(recording){                                        // If events are still written
+      Event event = {a, b};
+      buffer[used++] = event;                               // Buffer event
+      if(used == buffer.size()){                            // If buffer is full
+        fwrite(buffer.data(), sizeof(Event), used, file);     // Write it
+        used = 0;
+      }
+      events++;
+      begun += (a == TRACE_ITERATION);                      // Count iterations started
+    }
+    return true;
+  }
+
+  if(used == filled && !refill()){                      // If file has no more events
+    diverged = true;
+    return false;
+  }
+  const Event &event = buffer[used++];                  // Next event of file
+  events++;
+  diverged = diverged || event.a != a || event.b != b;
+  return !diverged;
+}
@@ -0,0 +1,88 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The TRC class records the trajectory of a GLS search to a
+ *              compact binary file and replays it. The file holds a header
+ *              with the problem size, seed, alpha and FLS iterations, the
+ *              tour the search started from, and one 8-byte event for each
+ *              iteration started, 2-opt move applied, edge penalized and
+ *              penalty reset. A replay rebuilds the same search state, runs
+ *              the recorded iterations again without a time limit, and
+ *              checks every event against the file, so two builds are timed
+ *              on exactly the same work, and a build that changes the
+ *              trajectory is caught at the first event that differs. The
+ *              time spent in fastLocalSearch() and updatePenalties() is
+ *              reported separately.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <climits>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define TRACE_ITERATION INT_MIN      // Event starting an iteration, with its number
+#define TRACE_RESET (INT_MIN + 1)    // Event resetting every penalty
+#define TRACE_PENALTY (-1)           // Penalty events hold TRACE_PENALTY - c1 and c2
+
+class GLS;
+
+/********************************************************************************
+ * Event is one step of a trajectory: a move's two tour positions, a
+ * penalized edge's cities, or a marker with its value.
+********************************************************************************/
+struct Event{
+	int a;                           // First tour position, encoded city, or marker
+	int b;                           // Second tour position, city, or marker value
+};
+
+/********************************************************************************
+ * TraceHeader starts a trace file. Its counts are filled in when recording
+ * finishes.
+********************************************************************************/
+struct TraceHeader{
+	char magic[8];                   // "GLSTRACE"
+	int size;                        // Count of cities
+	unsigned seed;                   // Seed of search's random numbers
+	int maxFLS;                      // FLS iterations before penalties are reset
+	int renumber;                    // Cities were renumbered along a Hilbert curve
+	double alpha;                    // GLS alpha
+	long iterations;                 // Count of iterations recorded whole
+	long events;                     // Count of events
+};
+
+class TRC{
+  public:
+	FILE *file;              // Trace file
+	bool replaying;          // Events are checked instead of written
+	bool recording;          // Events are still written
+	bool diverged;           // Replay made an event the file does not hold
+	TraceHeader header;      // Header of trace file
+	vector<int> start;       // Tour the search started from
+	vector<Event> buffer;    // Events waiting to be written, or read ahead
+	size_t used;             // Events of buffer written or checked
+	size_t filled;           // Events of buffer read from file
+	long events;             // Events written or checked
+	long begun;              // Iterations started while recording
+	long moves;              // Moves applied
+	long penalties;          // Edges penalized
+
+  public:
+	TRC();                                     // Constructor
+	~TRC();                                    // Deconstructor
+
+	bool record(GLS&, string, unsigned);       // Start recording a search to a file
+	void stop();                               // Stop recording within a cut iteration
+	bool finish();                             // Write remaining events and counts
+	bool open(string);                         // Read header and start tour of a file
+	bool replay(GLS&);                         // Replay the file's iterations and report times
+	bool refill();                             // Read ahead the next events
+
+	bool log(int, int);                        // Write or check one event
+};
+#endif
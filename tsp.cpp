@@ -7,8 +7,17 @@
  * Sources: see main.cpp header for program sources
 ********************************************************************************/
 #include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
 #include "tsp.hpp"
 
+#define PARSE_CHUNK_SIZE (1 << 20)   // Fewest bytes of input parsed by one thread
+#define MIN_THREAD_ROWS 256          // Fewest matrix rows filled by one thread
+
 /********************************************************************************
  * Constructor initializes variables.
 ********************************************************************************/
@@ -20,25 +29,23 @@ TSP::TSP(){
   time = 0;                     // Initialize current elapsed time to 0
   tourCost = 0;                 // Initialize current tour cost to 0
   bestCost = 0;                 // Initialize best tour cost to 0
+  shared = false;               // Initialize to owning coordinates and distances
+  hugePages = false;            // Initialize to regular pages
+  renumber = false;             // Initialize to file order
+  christofides = true;          // Initialize to Christofides starts for large problems
+  setRowThreads(std::thread::hardware_concurrency());   // Initialize to one thread per core
+  x = y = tour = best = NULL;   // Initialize arrays to empty
+  distance = NULL;
+  order = NULL;
+  setSeed(rand());              // Initialize seed from the program's random functions
 }
 
 /********************************************************************************
- * Deconstructor deletes all dynamically allocated memory
+ * Deconstructor frees all arrays at once by releasing the arena.
 ********************************************************************************/
 TSP::~TSP(){
-  delete [] x;                     // Delete x values
-  delete [] y;                     // Delete y values
-  if(size <= 5000){                // If size is <= 5,000 , we didn't use the Christofide's algorithm
-	  delete [] tour;                // Delete current tour
-  }
-  else{                            // Else
-	  delete obj;                    // Delete Christofide's object
-  }
-  delete [] best;                  // Delete best tour
-  for(int i = 0; i < size; i++){   // For each edge
- 	delete [] distance[i];           // Delete distance
-  }
-  delete [] distance;              // Delete distances
+  waitPending();                   // Let a background tour stop reading the distances
+  arena.release();                 // Unmap arena holding every array
 }
 
 /********************************************************************************
@@ -48,6 +55,49 @@ void TSP::setGlsIterations(int limit){
   maxGLS = limit;
 }
 
+/********************************************************************************
+ * setHugePages() sets whether the arena is backed by transparent huge pages.
+ * Must be called before the problem is set.
+********************************************************************************/
+void TSP::setHugePages(bool enable){
+  hugePages = enable;
+}
+
+/********************************************************************************
+ * setRenumber() sets whether cities read from a file are renumbered along a
+ * Hilbert curve, so cities near each other have nearby rows and slots in
+ * every array. Must be called before the problem is set.
+********************************************************************************/
+void TSP::setRenumber(bool enable){
+  renumber = enable;
+}
+
+/********************************************************************************
+ * setChristofides() sets whether problems above 5,000 cities are given a
+ * Christofides tour, whose spanning tree and matching take memory per city
+ * while it is built, or start from a random tour.
+********************************************************************************/
+void TSP::setChristofides(bool enable){
+  christofides = enable;
+}
+
+/********************************************************************************
+ * setRowThreads() sets the most threads that fill this object's distance and
+ * edge store rows, for objects initialized on several threads at once.
+********************************************************************************/
+void TSP::setRowThreads(int count){
+  rowThreads = max(count, 1);
+}
+
+/********************************************************************************
+ * setSeed() initializes this object's random numbers, so a search from the
+ * same seed makes the same moves, and objects on different threads draw
+ * their own numbers.
+********************************************************************************/
+void TSP::setSeed(unsigned seed){
+  generator.seed(seed);
+}
+
 /********************************************************************************
  * setMaxTime() initializes the algorithm time limit.
 ********************************************************************************/
@@ -59,111 +109,422 @@ void TSP::setMaxTime(double limit){
  * getDuration() calculates and returns the algorithm's elapsed time.
 ********************************************************************************/
 double TSP::getDuration(){
-  lap = clock();
-  double elapsed = (double)(lap - start) / (double) CLOCKS_PER_SEC;
+  lap = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(lap - start).count();
   return elapsed;
 }
 
+/********************************************************************************
+ * countCities() returns the number of non-blank lines in the input file, or
+ * -1 if the file does not exist. The file is read in large blocks.
+********************************************************************************/
+int TSP::countCities(string input){
+  FILE *file = fopen(input.c_str(), "r");               // Open file by name
+  if(!file){                                            // If file does not exist
+    return -1;                                            // Return that there are no cities
+  }
+  int count = 0;                                        // Count of cities
+  bool empty = true;                                    // Track if current line is empty so far
+  std::vector<char> block(PARSE_CHUNK_SIZE);            // Holds part of file
+  size_t length;
+  while((length = fread(block.data(), 1, block.size(), file)) > 0){   // While there is more of the file
+    for(size_t i = 0; i < length; i++){                   // For each character
+      if(block[i] == '\n'){                                // If line ends
+        count += !empty;                                      // Count it if it is not blank
+        empty = true;
+      }
+      else if(!isspace((unsigned char)block[i])){           // Else, if character is not blank
+        empty = false;
+      }
+    }
+  }
+  fclose(file);
+  return count + !empty;                                // Count last line without a newline
+}
+
+/********************************************************************************
+ * readCities() reads the x and y values of every city of an input file, one
+ * city per non-blank line as "ID x y", with cities in order of ID. The file
+ * is read at once and split into chunks at line ends, and each chunk is
+ * parsed on its own thread. Returns false if the file does not exist, a
+ * non-blank line is not three numbers, or the count of cities read differs
+ * from countCities(), with the reason in error if it is given.
+********************************************************************************/
+bool TSP::readCities(string input, std::vector<int> &xs, std::vector<int> &ys, string *error){
+  FILE *file = fopen(input.c_str(), "r");               // Open file by name
+  if(!file){                                            // If file does not exist
+    if(error) *error = "FILE NOT FOUND";
+    return false;                                         // End function by returning false
+  }
+  string text;                                          // Holds whole file
+  std::vector<char> block(PARSE_CHUNK_SIZE);
+  size_t length;
+  while((length = fread(block.data(), 1, block.size(), file)) > 0){   // While there is more of the file
+    text.append(block.data(), length);
+  }
+  fclose(file);
+
+  int chunks = max(1, min((int)std::thread::hardware_concurrency(),   // One chunk per thread,
+                          (int)(text.size() / PARSE_CHUNK_SIZE)));      // but not below the chunk size
+  std::vector<size_t> bounds(chunks + 1, text.size());  // Start of each chunk, plus end of text
+  bounds[0] = 0;
+  for(int k = 1; k < chunks; k++){                      // For each later chunk
+    size_t at = text.find('\n', text.size()*k/chunks);   // Start it after a line end
+    bounds[k] = (at == string::npos) ? text.size() : max(at + 1, bounds[k-1]);
+  }
+
+  std::vector<std::vector<int> > partX(chunks), partY(chunks);   // Cities of each chunk
+  std::vector<long> lines(chunks, 0);                   // Lines of each chunk
+  std::vector<long> bad(chunks, 0);                     // First bad line of each chunk, or 0
+  auto parse = [&](int k){                              // Parse one chunk
+    const char *p = text.c_str() + bounds[k], *end = text.c_str() + bounds[k+1];
+    while(p < end){                                       // For each line of chunk
+      const char *eol = (const char*)memchr(p, '\n', end - p);   // End of line
+      if(!eol){
+        eol = end;
+      }
+      lines[k]++;
+      while(p < eol && isspace((unsigned char)*p)){         // Skip leading blanks
+        p++;
+      }
+      if(p < eol){                                          // If line is not blank
+        long value[3];                                        // ID, x and y; ID is not needed since cities are in order
+        int read = 0;
+        char *next;
+        for(; read < 3; read++){                              // For each number of line
+          value[read] = strtol(p, &next, 10);
+          if(next == p || next > eol){                          // If it is missing or on a later line
+            break;
+          }
+          p = next;
+        }
+        while(p < eol && isspace((unsigned char)*p)){         // Skip trailing blanks
+          p++;
+        }
+        if(read < 3 || p < eol){                              // If line is not three numbers
+          bad[k] = lines[k];                                    // Record it and stop chunk
+          return;
+        }
+        partX[k].push_back(value[1]);
+        partY[k].push_back(value[2]);
+      }
+      p = eol + 1;
+    }
+  };
+  std::vector<std::thread> pool;
+  for(int k = 1; k < chunks; k++){                      // For each chunk but the first
+    pool.push_back(std::thread(parse, k));                // Parse it on its own thread
+  }
+  parse(0);                                             // Parse first chunk on this thread
+  for(unsigned k = 0; k < pool.size(); k++){
+    pool[k].join();
+  }
+
+  xs.clear();
+  ys.clear();
+  long line = 0;                                        // Lines of earlier chunks
+  for(int k = 0; k < chunks; k++){                      // For each chunk in order
+    if(bad[k]){                                           // If chunk has a bad line
+      if(error) *error = "BAD LINE " + std::to_string(line + bad[k]);
+      return false;
+    }
+    line += lines[k];
+    xs.insert(xs.end(), partX[k].begin(), partX[k].end());
+    ys.insert(ys.end(), partY[k].begin(), partY[k].end());
+  }
+  if((int)xs.size() != countCities(input)){             // If a city was lost or gained
+    if(error) *error = "CITY COUNT MISMATCH";
+    return false;
+  }
+  return true;                                          // End function by returning true
+}
+
+/********************************************************************************
+ * getDistance() returns the Euclidean distance between two points rounded to
+ * the nearest integer, the distance every solver and the verifier use.
+********************************************************************************/
+int TSP::getDistance(int x1, int y1, int x2, int y2){
+  return round(sqrt(pow((double)(x1 - x2), 2) + pow((double)(y1 - y2), 2)));
+}
+
+/********************************************************************************
+ * forRows() splits the rows of a matrix into one block per thread, using at
+ * most the given count of threads, and calls the function with the first and
+ * last row of each block, the first block on this thread. Each thread
+ * writes, and so places, its own rows.
+********************************************************************************/
+void TSP::forRows(int rows, std::function<void(int, int)> fill, int threads){
+  int count = max(1, min(min((int)std::thread::hardware_concurrency(), threads), rows / MIN_THREAD_ROWS));
+  std::vector<std::thread> pool;
+  for(int k = 1; k < count; k++){                       // For each block but the first
+    pool.push_back(std::thread(fill, (long)rows*k/count, (long)rows*(k + 1)/count));
+  }
+  fill(0, rows/count);                                  // Fill first block on this thread
+  for(unsigned k = 0; k < pool.size(); k++){
+    pool[k].join();
+  }
+}
+
 /********************************************************************************
  * setProblem() reads in cities from user defined input file, creates dynamic
- * arrays for city coordinates, edge distances, current tour, and initial
- * tour, and calculates and records all possible edge distances.
+ * arrays for city coordinates, and calls function to create the tour arrays
+ * and record all possible edge distances.
 ********************************************************************************/
 bool TSP::setProblem(string input){
-  start = clock();                                      // Set program timer
+  start = std::chrono::steady_clock::now();             // Set program timer
 
   fileName = input;                                     // Initialize filename to user input
 
-  inputFile.open(fileName);                             // Open file by name
-  if(inputFile){                                        // If file exists
-    string line;                                          // Holds file line
-    while(!inputFile.eof()){                              // While haven't reached EOF
-      getline(inputFile, line);                             // Get next line from file
-      if(line != ""){                                       // If the line is not null
-    	  size++;                                             // Increment the problem size
+  std::vector<int> xs, ys;                              // Hold cities' coordinates
+  string error;                                         // Reason file cannot be read
+  if(!readCities(fileName, xs, ys, &error)){            // If file cannot be read
+    size = 0;                                             // Reset problem size
+    std::cerr << "ERROR: " << error << endl;              // Print error message
+	return false;                                         // End function by returning false
+  }
+
+  size = xs.size();                                     // Count cities in file
+  if(!setArena()){                                      // If arrays do not fit in memory
+    return false;                                         // End function by returning false
+  }
+  x = arena.allocate<int>(size);                        // Create array for x coordinate values
+  y = arena.allocate<int>(size);                        // Create array for y coordinate values
+  std::copy(xs.begin(), xs.end(), x);                   // Copy x values
+  std::copy(ys.begin(), ys.end(), y);                   // Copy y values
+
+  if(renumber){                                         // If renumbering was requested
+    setHilbertOrder();                                    // Renumber cities before building arrays
+  }
+  setDistances();                                       // Call function to create tour arrays and distances
+  return true;                                          // End function by returning true
+}
+
+/********************************************************************************
+ * setProblem() copies cities' coordinates from arrays instead of reading an
+ * input file, then creates the tour arrays and records all edge distances.
+ * Used to solve subproblems of a larger instance, and jobs of the server,
+ * which reuse one object and its arena for many problems. The coordinates of
+ * city i are read at xs[i*stride] and ys[i*stride], so interleaved x and y
+ * values are read in place.
+********************************************************************************/
+bool TSP::setProblem(const int *xs, const int *ys, int count, int stride){
+  start = std::chrono::steady_clock::now();             // Set program timer
+  iteration = 0;                                        // Restart iteration count
+
+  size = count;                                         // Initialize problem size
+  if(!setArena()){                                      // If arrays do not fit in memory
+    return false;                                         // End function by returning false
+  }
+  x = arena.allocate<int>(size);                        // Create array for x coordinate values
+  y = arena.allocate<int>(size);                        // Create array for y coordinate values
+  for(int i = 0; i < size; i++){                        // For each city
+    x[i] = xs[(size_t)i*stride];                          // Copy x value
+    y[i] = ys[(size_t)i*stride];                          // Copy y value
+  }
+
+  setDistances();                                       // Call function to create tour arrays and distances
+  return true;                                          // End function by returning true
+}
+
+/********************************************************************************
+ * setProblem() shares the source's city coordinates and distance matrix
+ * instead of building its own, and creates its own tour arrays. Used to run
+ * several algorithm objects on one problem; the source must outlive them.
+********************************************************************************/
+void TSP::setProblem(const TSP &source){
+  start = source.start;                                 // Share program timer
+  fileName = source.fileName;                           // Share filename
+
+  shared = true;                                        // Coordinates and distances belong to source
+  size = source.size;                                   // Initialize problem size
+  x = source.x;                                         // Share x values
+  y = source.y;                                         // Share y values
+  distance = source.distance;                           // Share distances
+  order = source.order;                                 // Share original IDs
+  setArena();                                           // Map arena for own arrays
+  setTours();                                           // Call function to create tour arrays
+}
+
+/********************************************************************************
+ * setDistances() creates the tour arrays, then creates the dynamic array
+ * for edge distances, and calculates and records all possible edge distances.
+********************************************************************************/
+void TSP::setDistances(){
+  setTours();                                           // Call function to create tour arrays
+
+  distance = arena.allocate<int*>(size);                // Create matrix to hold distances between each city
+  int *rows = arena.allocate<int>((size_t)size*size);   // Create one block for all rows
+  for(int i = 0; i < size; i++){                        // For each city
+    distance[i] = rows + (size_t)i*size;                  // Point to second dimension for distance to each city
+  }
+
+  forRows(size, [this](int first, int last){            // For each block of rows, on its own thread
+    for(int i = first; i < last; i++){                      // For each city
+      for(int j = 0; j < size; j++) {                         // For each edge to every city
+        distance[i][j] = getDistance(x[i], y[i], x[j], y[j]);   // Record Euclidean distance from city i to j
       }
     }
-    inputFile.close();                                    // Close input file
+  }, rowThreads);
+}
+
+/********************************************************************************
+ * setTours() sets the iteration limit for the problem size and creates
+ * dynamic arrays for the current tour and best tour.
+********************************************************************************/
+void TSP::setTours(){
+  if(size < 200){                                       // If problem size < 200
+  	setGlsIterations(5000);                             // Set GLS iterations to 5,000
+  }
+  else if(size < 250){                                  // Else, if 200 < size < 300
+  	setGlsIterations(10000);                            // Set GLS iterations to 10,000
+  }
+  else if(size < 400){                                  // Else, if 300 < size < 400
+  	setGlsIterations(85000);                           // Set GLS iterations to 100,000
+  }
+  else if(size < 500){                                  // Else, if 400 < size < 500
+  	setGlsIterations(200000);                           // Set GLS  iterations to 200,000
+  }
+  else if(size < 1000){                                 // Else, if 500 < size < 1,000
+  	setGlsIterations(300000);                           // Set GLS iterations to 300,000
   }
   else{                                                 // Else
-    cout << "ERROR: FILE NOT FOUND" << endl;              // Print error message
-	return false;                                         // End function by returning false
+  	setGlsIterations(INT_MAX);                          // Set GLS iterations to maximum possible within time limit
   }
 
-  inputFile.open(fileName);                             // Open file again
-  if(inputFile){                                        // If file opens
-    if(size < 200){                                       // If problem size < 200
-    	setGlsIterations(5000);                             // Set GLS iterations to 5,000
-    }
-    else if(size < 250){                                  // Else, if 200 < size < 300
-    	setGlsIterations(10000);                            // Set GLS iterations to 10,000
-    }
-    else if(size < 400){                                  // Else, if 300 < size < 400
-    	setGlsIterations(85000);                           // Set GLS iterations to 100,000
-    }
-    else if(size < 500){                                  // Else, if 400 < size < 500
-    	setGlsIterations(200000);                           // Set GLS  iterations to 200,000
-    }
-    else if(size < 1000){                                 // Else, if 500 < size < 1,000
-    	setGlsIterations(300000);                           // Set GLS iterations to 300,000
-    }
-    else{                                                 // Else
-    	setGlsIterations(INT_MAX);                          // Set GLS iterations to maximum possible within time limit
-    }
+  tour = arena.allocate<int>(size);                     // Create tour array to hold current order of cities
+  best = arena.allocate<int>(size);                     // Create best array to hold best order of cities
+}
 
-	int null;                                             // Holds city ID (not needed since we assume cities are in order)
-    x = new int[size];                                    // Create array for x coordinate values
-    y = new int[size];                                    // Create array for y coordinate values
-    if(size <= 5000){                                     // If problem size is <= 5,000, we use don't use Christofide's
-      tour = new int[size];                                 // Create tour array to hold current order of cities
-    }
-    best = new int[size];                                 // Create best array to hold best order of cities
-    distance = new int*[size];                            // Create matrix to hold distances between each city
-    for(int i = 0; i < size; i++){                        // For each city
-      distance[i] = new int[size];                          // Create second dimension for distance to each city
-    }
-  
-    int xValue, yValue;                                   // Hold  city's coordinates
-    for(int i = 0; i < size; i++) {                       // For each city
-      inputFile >> null >> xValue >> yValue;                // Read ID, x value and y value into variables
-      x[i] = xValue;                                        // Assign x variable to corresponding city ID in x array
-      y[i] = yValue;                                        // Assign y variable to corresponding city ID in y array
-    }
-  
-    for(int i = 0; i < size; i++){                        // For each city
-      for(int j = 0; j < size; j++) {                       // For each edge to every city
-        double dist = round(sqrt(pow((x[i] - x[j]), 2) +      // Calculate Euclidean distance
-        		      pow((y[i] - y[j]), 2)));
-        distance[j][i] = dist;                                // Record distance from city i to j
-        distance[i][j] = dist;                                // Record same distance from city j to i
+/********************************************************************************
+ * setHilbertOrder() sorts the cities by their position on a Hilbert curve
+ * over the cities' bounding box, and records each city's original ID so the
+ * tour can be written in original IDs.
+********************************************************************************/
+void TSP::setHilbertOrder(){
+  std::vector<int> xs(x, x + size), ys(y, y + size);    // Hold coordinates in file order
+  order = arena.allocate<int>(size);                    // Create array for original IDs
+  setHilbertTour(order);                                // Order original IDs along curve
+  for(int i = 0; i < size; i++){                        // For each place on curve
+    x[i] = xs[order[i]];                                  // Move city to its new ID
+    y[i] = ys[order[i]];
+  }
+}
+
+/********************************************************************************
+ * setHilbertTour() generates a tour visiting the cities in the order of
+ * their positions on a Hilbert curve over the cities' bounding box. Cities
+ * near each other in the tour are near each other in the plane.
+********************************************************************************/
+void TSP::setHilbertTour(int *tour){
+  int minX = INT_MAX, maxX = INT_MIN, minY = INT_MAX, maxY = INT_MIN;
+  for(int i = 0; i < size; i++){                        // For each city
+    minX = min(minX, x[i]); maxX = max(maxX, x[i]);       // Extend bounding box
+    minY = min(minY, y[i]); maxY = max(maxY, y[i]);
+  }
+  double span = max((double)maxX - minX, (double)maxY - minY);   // Longer side, which may not fit an int
+  double scale = 65535.0 / max(1.0, span);              // Fit box in curve's grid
+
+  std::vector<std::pair<long, int> > keys(size);        // Curve position and city
+  for(int i = 0; i < size; i++){                        // For each city
+    keys[i].first = getHilbertIndex(((double)x[i] - minX)*scale, ((double)y[i] - minY)*scale);
+    keys[i].second = i;
+  }
+  std::sort(keys.begin(), keys.end());                  // Order cities along curve
+  for(int i = 0; i < size; i++){                        // For each place on curve
+    tour[i] = keys[i].second;                             // Record city
+  }
+}
+
+/********************************************************************************
+ * getHilbertIndex() returns the position of a point on a Hilbert curve
+ * filling a 65,536 x 65,536 grid.
+********************************************************************************/
+long TSP::getHilbertIndex(int px, int py){
+  long index = 0;
+  for(int s = 1 << 15; s > 0; s >>= 1){                 // For each level, coarsest first
+    int rx = (px & s) > 0;                                // Quadrant of point at this level
+    int ry = (py & s) > 0;
+    index += (long)s * s * ((3 * rx) ^ ry);
+    if(ry == 0){                                          // Rotate quadrant to curve's orientation
+      if(rx == 1){
+        px = 65535 - px;
+        py = 65535 - py;
       }
+      std::swap(px, py);
     }
-    inputFile.close();                                    // Close input file
-    return true;                                          // End function by returning true
   }
-  else{                                                 // Else
-    cout << "ERROR: FILE NOT FOUND" << endl;              // Print error message
-    return false;                                         // End function by returning false
+  return index;
+}
+
+/********************************************************************************
+ * setArena() maps one arena large enough for every array the object will
+ * create, as counted by getArenaSize().
+********************************************************************************/
+bool TSP::setArena(){
+  waitPending();                                        // Let a background tour stop reading the old arena
+  return arena.reserve(getArenaSize(), hugePages);
+}
+
+/********************************************************************************
+ * getArenaSize() returns the bytes needed by the coordinates, tours and
+ * distance matrix, leaving out arrays shared from another object. Derived
+ * classes add the bytes of their own arrays.
+********************************************************************************/
+size_t TSP::getArenaSize(){
+  size_t bytes = 2*Arena::align(size*sizeof(int));                 // Current and best tours
+  if(!shared){                                                     // If coordinates and distances are owned
+    bytes += 2*Arena::align(size*sizeof(int));                       // x and y values
+    bytes += Arena::align(size*sizeof(int*));                        // Distance rows
+    bytes += Arena::align((size_t)size*size*sizeof(int));            // Distances
+    if(renumber){                                                    // If cities are renumbered
+      bytes += Arena::align(size*sizeof(int));                         // Original IDs
+    }
   }
+  return bytes;
 }
 
 /********************************************************************************
  * initialize() creates the first tour, gets the cost, and copies them to
- * the best tour.
+ * the best tour. Problems above 5,000 cities start from a Christofides tour.
+ * With a spare core, they start at once from a Hilbert curve tour instead,
+ * and their Christofides tour is built on a background thread from the
+ * finished distances, for the search to take if it is better.
 ********************************************************************************/
 void TSP::initialize(){
-  if(size <= 5000){                  // If size is <= 5000
+  if(size <= CHRISTOFIDES_SIZE || !christofides){   // If size is <= 5000, or Christofides does not fit
 	 setRandomTour(tour);              // Call function to generate random first tour
   }
+  else if(std::thread::hardware_concurrency() < 2){   // Else, if there is no spare core
+    CHR obj(distance, size);           // Create Christofide's class object
+    int *path = obj.getChristofides(); // Heuristically generate first tour
+    for(int i = 0; i < size; i++){     // For each city in tour
+      tour[i] = path[i];                 // Copy into arena before object deletes it
+    }
+  }
   else{                              // Else
-    obj = new CHR(distance, size);     // Create Christofide's class object
-    tour = obj->getChristofides();     // Heuristically generate firt tour
+    setHilbertTour(tour);              // Start from a quick tour along a Hilbert curve
+    pending = std::async(std::launch::async, [this](){   // Build Christofides tour in the background
+      CHR obj(distance, size);           // Create Christofide's class object
+      int *path = obj.getChristofides(); // Heuristically generate first tour
+      return std::vector<int>(path, path + size);   // Copy before object deletes it
+    });
   }
 
   tourCost = getTourCost(tour);      // Get the cost of the tour
   setBest();                         // Set the best tour as current tour
 }
 
+/********************************************************************************
+ * waitPending() waits for a Christofides tour still being built in the
+ * background, and drops it. Called before the distances it reads are freed.
+********************************************************************************/
+void TSP::waitPending(){
+  if(pending.valid()){               // If a tour is being built
+    pending.wait();                    // Wait for it to finish
+    pending = std::future<std::vector<int> >();   // Drop it
+  }
+}
+
 /********************************************************************************
  * setRandomTour() generates a random permutation of the tour of cities.
 ********************************************************************************/
@@ -172,7 +533,7 @@ void TSP::setRandomTour(int *tour){
     tour[i] = i;                                    // Initialize ID to i
   }
 
-  std::random_shuffle(&tour[0], &tour[size-1]);  // Call function to randomize tour order
+  std::shuffle(&tour[0], &tour[size-1], generator);   // Call function to randomize tour order
 }
 
 /********************************************************************************
@@ -181,13 +542,21 @@ void TSP::setRandomTour(int *tour){
  * finish time and output the algorithm results.
 ********************************************************************************/
 void TSP::runAlgorithm(){
+  search();                          // Run the algorithm
+  outputResults();                   // Call function to print algorithm results
+}
+
+/********************************************************************************
+ * search() runs the algorithm until it reaches the iteration or time limit
+ * and records the finish time, leaving the best tour in memory.
+********************************************************************************/
+void TSP::search(){
   while(!hasReachedLimit()){         // While algorithm hasn't reached iteration or time limit
       iteration++;                     // Increment count of GLS iterations
       guidedLocalSearch();             // Run guided local search
   }
 
   time = getDuration();              // Get running duration of algorithm
-  outputResults();                   // Call function to print algorithm results
 }
 
 /********************************************************************************
@@ -262,7 +631,7 @@ void TSP::outputResults(){
 
   outputFile << bestCost << "\n";                  // Write best cost to file
   for(int i = 0; i < size; i++){                   // For each city in best tour
-    outputFile  << best[i] << "\n";                  // Write city identifier file
+    outputFile  << (order ? order[best[i]] : best[i]) << "\n";   // Write original city identifier to file
   }
   outputFile.close();                              // Close output file
 
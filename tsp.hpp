@@ -18,7 +18,13 @@
 #include <limits.h>
 #include <math.h>
 #include <fstream>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <random>
+#include <vector>
 #include "christofides.hpp"
+#include "arena.hpp"
 
 using std::string;
 using std::cout;
@@ -28,6 +34,7 @@ using std::ofstream;
 using std::min;
 using std::max;
 
+#define CHRISTOFIDES_SIZE 5000     // Problems larger than this start from a Christofides tour
 
 class TSP{
   public:
@@ -38,34 +45,61 @@ class TSP{
 	double time;             // Current time
 	int	tourCost;            // Current tour distance
 	int	bestCost;            // Best tour distance
+	bool shared;             // Coordinates and distances belong to another object
+	bool hugePages;          // Back arena with transparent huge pages
+	bool renumber;           // Renumber cities along a Hilbert curve
+	bool christofides;       // Start large problems from a Christofides tour
+	int rowThreads;          // Most threads filling this object's matrix rows
 
-	CHR *obj;                // Christofide's object
+	Arena arena;             // Memory holding all arrays
 	int *x;                  // Cities' x values
 	int *y;                  // Cities' y values
 	int *tour;               // Current tour
 	int	*best;               // Best tour
 	int	**distance;          // Distances of all possible tour edges
+	int *order;              // Original ID of each renumbered city, or NULL
+	std::future<std::vector<int> > pending;   // Christofides tour being built in the background
+	std::mt19937 generator;  // Random numbers of this object
 
-	ifstream inputFile;      // Input file object
 	ofstream outputFile;     // Output file object
 	string fileName;         // Input file name
 
-	clock_t start;           // Algorithm start time
-	clock_t lap;             // Algorithm iteration lap time
+	std::chrono::steady_clock::time_point start;   // Algorithm start time
+	std::chrono::steady_clock::time_point lap;     // Algorithm iteration lap time
 
   public:
     TSP();                                     // Constructor
 	virtual	~TSP();                            // Deconstructor
 
 	void setGlsIterations(int);                // Set max iterations of running GLS
+	void setHugePages(bool);                   // Set whether arena uses huge pages
+	void setRenumber(bool);                    // Set whether cities are renumbered
+	void setChristofides(bool);                // Set whether large problems start from Christofides
+	void setRowThreads(int);                   // Set most threads filling matrix rows
     void setMaxTime(double);                   // Set max time for running algorithm
+	void setSeed(unsigned);                    // Set seed of random numbers
 	double getDuration();                      // Get algorithm elapsed time
 
-	bool setProblem(string);                   // Initialize record of cities
-	void initialize();                         // Initialize dynamic arrays
+	bool setProblem(string);                   // Initialize record of cities from file
+	bool setProblem(const int*, const int*, int, int = 1);   // Initialize record of cities from coordinates
+	void setProblem(const TSP&);               // Share record of cities with another object
+	void setDistances();                       // Create tour arrays and distance matrix
+	void setTours();                           // Create tour arrays
+	void setHilbertOrder();                    // Renumber cities along a Hilbert curve
+	void setHilbertTour(int*);                 // Generate a tour along a Hilbert curve
+	static long getHilbertIndex(int, int);     // Get position of a point on the Hilbert curve
+	bool setArena();                           // Map arena for all arrays
+	virtual size_t getArenaSize();             // Get bytes needed by all arrays
+	static int countCities(string);            // Count cities in input file
+	static bool readCities(string, std::vector<int>&, std::vector<int>&, string* = NULL);   // Read cities' coordinates from input file
+	static int getDistance(int, int, int, int);   // Get rounded distance between two points
+	static void forRows(int, std::function<void(int, int)>, int = INT_MAX);   // Split rows of a matrix over threads
+	virtual void initialize();                 // Initialize dynamic arrays
 	void setRandomTour(int *);                 // Generate a random initial tour
+	void waitPending();                        // Wait for a background Christofides tour
 
 	void runAlgorithm();                       // Run the algorithm
+	void search();                             // Run the algorithm without writing results
 	virtual void guidedLocalSearch();          // Driving algorithm
 
 	int	getNext(int);                          // Get city's next neighbor
@@ -0,0 +1,245 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the TUN class. Here, you
+ *              can find definitions of class functions.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include "planner.hpp"
+#include "tuning.hpp"
+
+#define FEATURES 4                 // Constant, log(cities), clustering, log(seconds)
+#define SAMPLE_SIZE 1000           // Cities sampled for nearest neighbor distances
+
+static const double ALPHAS[] = {0.1, 0.167, 0.3, 0.5, 0.7};   // Alpha values tried
+static const int FLS[] = {10, 20, 100};                      // FLS iteration values tried
+
+/********************************************************************************
+ * loadProfile() reads the settings of a profile file. Lines starting with
+ * '#' are comments. Returns false if the file does not exist or holds no
+ * settings.
+********************************************************************************/
+bool TUN::loadProfile(string input){
+  ifstream file(input);                                 // Open profile
+  string line;                                          // Holds file line
+  settings.clear();
+  while(getline(file, line)){                           // For each line
+    if(line.empty() || line[0] == '#'){                   // If line is a comment
+      continue;
+    }
+    std::istringstream fields(line);
+    Setting s;
+    if(fields >> s.alpha >> s.fls >> s.fit[0] >> s.fit[1] >> s.fit[2] >> s.fit[3]){
+      settings.push_back(s);                                // Keep setting
+    }
+  }
+  return !settings.empty();
+}
+
+/********************************************************************************
+ * saveProfile() writes the settings to a profile file.
+********************************************************************************/
+bool TUN::saveProfile(string output){
+  ofstream file(output.c_str());                        // Create profile
+  file << "# alpha fls c0 c1 c2 c3: relative cost = c0 + c1*log(cities)"
+          " + c2*clustering + c3*log(seconds)\n";
+  for(unsigned i = 0; i < settings.size(); i++){        // For each setting
+    Setting &s = settings[i];
+    file << s.alpha << " " << s.fls;
+    for(int j = 0; j < FEATURES; j++){
+      file << " " << s.fit[j];
+    }
+    file << "\n";
+  }
+  return (bool)file;
+}
+
+/********************************************************************************
+ * getFeatures() records the features of an initialized object's problem at
+ * its time limit. Clustering compares the mean nearest neighbor distance of
+ * a sample of cities with 0.5*sqrt(area/cities), its expected value for
+ * cities spread uniformly over their bounding box.
+********************************************************************************/
+void TUN::getFeatures(GLS &obj, double *features){
+  int size = obj.size;
+  int minX = INT_MAX, maxX = INT_MIN, minY = INT_MAX, maxY = INT_MIN;
+  for(int i = 0; i < size; i++){                        // For each city
+    minX = min(minX, obj.x[i]); maxX = max(maxX, obj.x[i]);   // Extend bounding box
+    minY = min(minY, obj.y[i]); maxY = max(maxY, obj.y[i]);
+  }
+
+  int step = max(1, size / SAMPLE_SIZE);                // Distance between sampled cities
+  double total = 0;                                     // Sum of nearest neighbor distances
+  int sampled = 0;
+  for(int i = 0; i < size; i += step){                  // For each sampled city
+    int nearest = INT_MAX;
+    for(int j = 0; j < size; j++){                        // For each other city
+      if(j != i){
+        nearest = min(nearest, obj.distance[i][j]);
+      }
+    }
+    total += nearest;
+    sampled++;
+  }
+  double area = (double)(maxX - minX) * (maxY - minY);  // Bounding box area
+  double expected = 0.5*sqrt(area / size);              // Uniform nearest neighbor distance
+
+  features[0] = 1;                                      // Constant
+  features[1] = log((double)size);                      // Log of cities
+  features[2] = expected > 0 ? total / sampled / expected : 1;   // Clustering
+  features[3] = log(max(obj.maxTime, 0.01));            // Log of seconds
+}
+
+/********************************************************************************
+ * getSetting() returns the index of the setting with the lowest predicted
+ * relative cost for the features.
+********************************************************************************/
+int TUN::getSetting(const double *features){
+  int chosen = 0;
+  double lowest = INFINITY;
+  for(unsigned i = 0; i < settings.size(); i++){        // For each setting
+    double predicted = 0;
+    for(int j = 0; j < FEATURES; j++){
+      predicted += settings[i].fit[j] * features[j];
+    }
+    if(predicted < lowest){                               // If setting is the best so far
+      lowest = predicted;
+      chosen = i;
+    }
+  }
+  return chosen;
+}
+
+/********************************************************************************
+ * setParameters() sets alpha and the FLS iterations of an initialized GLS
+ * object from the best predicted setting. Does nothing without settings.
+********************************************************************************/
+void TUN::setParameters(GLS &obj){
+  if(settings.empty()){                                 // If no profile is loaded
+    return;                                               // Keep size table values
+  }
+  double features[FEATURES];
+  getFeatures(obj, features);                           // Describe problem
+  Setting &s = settings[getSetting(features)];
+  obj.setAlpha(s.alpha);                                // Apply setting
+  obj.setFlsIterations(s.fls);
+}
+
+/********************************************************************************
+ * train() runs a GLS trial for every setting of the grid on every instance
+ * at a quarter of the time limit and at the full time limit. Trials run at
+ * once on one core each, or two when the largest instance builds its
+ * Christofides tour in the background, and only as many as the arenas of
+ * the largest instance fit the memory limit, so a trial's cost reflects its
+ * setting rather than contention. Each trial's cost is divided by the best
+ * cost of its instance and time limit, and a ridge regression of that
+ * relative cost on the features is fitted for each setting.
+********************************************************************************/
+void TUN::train(const vector<string> &files, double seconds, size_t limit){
+  settings.clear();
+  for(double alpha : ALPHAS){                           // For each setting in the grid
+    for(int fls : FLS){
+      Setting s = {alpha, fls, {0, 0, 0, 0}};
+      settings.push_back(s);
+    }
+  }
+  double budgets[2] = {seconds / 4, seconds};           // Time limits tried
+  int runs = files.size() * 2;                          // Count of instance and time limit pairs
+  int trials = runs * settings.size();                  // Count of trials
+
+  vector<int> costs(trials, -1);                        // Best cost of each trial
+  vector<double> features((size_t)trials * FEATURES);   // Features of each trial
+  std::atomic<int> next(0);                             // Next trial to run
+  auto worker = [&](){                                  // Run trials until none are left
+    int t;
+    while((t = next++) < trials){
+      int run = t / settings.size();
+      GLS obj;
+      obj.setMaxTime(budgets[run % 2]);                     // Set trial's time limit
+      if(!obj.TSP::setProblem(files[run / 2])){             // If instance cannot be read
+        continue;
+      }
+      obj.initialize();                                     // Initialize dynamic arrays
+      obj.setAlpha(settings[t % settings.size()].alpha);    // Apply trial's setting
+      obj.setFlsIterations(settings[t % settings.size()].fls);
+      getFeatures(obj, &features[(size_t)t * FEATURES]);
+      obj.search();                                         // Run the algorithm
+      costs[t] = obj.bestCost;
+    }
+  };
+  int largest = 0;                                      // Cities of largest instance
+  for(unsigned i = 0; i < files.size(); i++){
+    largest = max(largest, TSP::countCities(files[i]));
+  }
+  size_t bytes = PLN::getSolverSize(largest, false, 1, false);   // Footprint of one trial
+  int cores = max(1, (int)std::thread::hardware_concurrency());
+  int used = 1;                                         // Cores used by one trial
+  if(largest > CHRISTOFIDES_SIZE){                      // If its first tour is Christofides
+    bytes += PLN::getChristofidesSize(largest);
+    used = cores >= 2 ? 2 : 1;                            // Built on a second thread when there is a core for it
+  }
+  int threads = max(1, min(cores / used, (int)min(limit / max(bytes, (size_t)1), (size_t)cores)));
+  vector<std::thread> pool;
+  for(int i = 0; i < threads; i++){                     // For each trial run at once
+    pool.push_back(std::thread(worker));                  // Start thread
+  }
+  for(int i = 0; i < threads; i++){
+    pool[i].join();                                       // Wait for trials to finish
+  }
+
+  for(unsigned k = 0; k < settings.size(); k++){        // For each setting
+    double a[FEATURES][FEATURES + 1] = {};                // Normal equations, right side last
+    int rows = 0;                                         // Count of trials fitted
+    for(int run = 0; run < runs; run++){                  // For each instance and time limit
+      int lowest = INT_MAX;                                 // Best cost of any setting
+      for(unsigned j = 0; j < settings.size(); j++){
+        int c = costs[run * settings.size() + j];
+        if(c >= 0) lowest = min(lowest, c);
+      }
+      int t = run * settings.size() + k;
+      if(costs[t] < 0 || lowest <= 0){                      // If instance was not solved
+        continue;
+      }
+      double ratio = (double)costs[t] / lowest;             // Cost relative to best setting
+      rows++;
+      double *f = &features[(size_t)t * FEATURES];
+      for(int i = 0; i < FEATURES; i++){                    // Accumulate normal equations
+        for(int j = 0; j < FEATURES; j++){
+          a[i][j] += f[i] * f[j];
+        }
+        a[i][FEATURES] += f[i] * ratio;
+      }
+    }
+    for(int i = 1; i < FEATURES; i++){                    // Ridge on all but the constant, so
+      a[i][i] += 1e-3;                                      // few instances still give a fit
+    }
+    a[0][0] += 1e-9;
+
+    for(int i = 0; i < FEATURES; i++){                    // Solve by Gaussian elimination
+      int pivot = i;
+      for(int r = i + 1; r < FEATURES; r++){
+        if(fabs(a[r][i]) > fabs(a[pivot][i])) pivot = r;
+      }
+      for(int j = 0; j <= FEATURES; j++){
+        std::swap(a[i][j], a[pivot][j]);
+      }
+      for(int r = 0; r < FEATURES; r++){
+        if(r != i && a[i][i] != 0){
+          double factor = a[r][i] / a[i][i];
+          for(int j = i; j <= FEATURES; j++){
+            a[r][j] -= factor * a[i][j];
+          }
+        }
+      }
+    }
+    for(int i = 0; i < FEATURES; i++){
+      settings[k].fit[i] = a[i][i] != 0 ? a[i][FEATURES] / a[i][i] : 0;
+    }
+    if(rows == 0){                                        // If setting was never tried
+      settings[k].fit[0] = 2;                               // Predict it twice as costly as the best
+    }
+  }
+}
@@ -0,0 +1,47 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The TUN class picks GLS parameters from a profile instead of
+ *              the size tables in GLS::initializeSearch(). Training runs short
+ *              GLS trials for every setting in a grid of alpha and FLS
+ *              iteration values on a set of instances at two time limits, and
+ *              fits, for each setting, the cost relative to the best setting
+ *              as a linear function of
+ *
+ *                log(cities), clustering, log(seconds)
+ *
+ *              where clustering is the mean nearest neighbor distance over
+ *              its expected value for uniformly spread cities (near 1 when
+ *              uniform, smaller when clustered). For a new instance the
+ *              setting with the lowest predicted relative cost is used.
+ *
+ *              Profile file lines: alpha fls c0 c1 c2 c3
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef TUNING_HPP
+#define TUNING_HPP
+
+#include <vector>
+#include "gls.hpp"
+
+using std::vector;
+
+struct Setting{
+	double alpha;            // GLS alpha
+	int fls;                 // GLS iteration at which penalties are reset
+	double fit[4];           // Predicted relative cost, by feature
+};
+
+class TUN{
+  public:
+	vector<Setting> settings;  // Settings of the profile
+
+  public:
+	bool loadProfile(string);                  // Read settings from profile file
+	bool saveProfile(string);                  // Write settings to profile file
+	void train(const vector<string>&, double, size_t);   // Fit settings on instances at a time limit
+	void setParameters(GLS&);                  // Apply best predicted setting to an initialized GLS object
+	int getSetting(const double*);             // Get setting with lowest predicted cost
+	static void getFeatures(GLS&, double*);    // Get features of an initialized object's problem
+};
+#endif
@@ -0,0 +1,228 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: This is the implementation file for the VER class and the
+ *              main function of the tsp-verify program.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include "tsp.hpp"
+#include "verify.hpp"
+
+/********************************************************************************
+ * Constructor initializes variables.
+********************************************************************************/
+VER::VER(){
+  setThreads(std::thread::hardware_concurrency());   // Use one thread per core
+}
+
+/********************************************************************************
+ * setThreads() initializes the count of threads.
+********************************************************************************/
+void VER::setThreads(int count){
+  threads = max(count, 1);
+}
+
+/********************************************************************************
+ * readTour() reads the cost on the first line of a tour file and the city on
+ * each following line. Returns false if the file does not exist or a line
+ * is not a number.
+********************************************************************************/
+bool VER::readTour(string input, long long &claimed, vector<int> &cities){
+  FILE *file = fopen(input.c_str(), "r");               // Open file by name
+  if(!file){                                            // If file does not exist
+    return false;
+  }
+  bool valid = fscanf(file, "%lld", &claimed) == 1;     // Read cost
+  int city;
+  while(valid && fscanf(file, "%d", &city) == 1){       // For each city
+    cities.push_back(city);
+  }
+  valid = valid && feof(file);                          // Whole file must be numbers
+  fclose(file);
+  return valid;
+}
+
+/********************************************************************************
+ * countLines() returns the count of lines of a file holding anything but
+ * blanks, read line by line apart from the solver's loader, or -1 if the
+ * file does not exist.
+********************************************************************************/
+long VER::countLines(string input){
+  ifstream file(input.c_str());
+  if(!file){                                            // If file does not exist
+    return -1;
+  }
+  long count = 0;                                       // Count of non-blank lines
+  string line;
+  while(getline(file, line)){                           // For each line
+    if(line.find_first_not_of(" \t\r\v\f") != string::npos){   // If it holds anything but blanks
+      count++;
+    }
+  }
+  return count;
+}
+
+/********************************************************************************
+ * check() checks one instance and tour pair. The tour is split into one part
+ * per thread; each thread marks the cities of its part as seen, catching any
+ * city seen twice or out of range, and adds up the distances from each of its
+ * cities to the next.
+********************************************************************************/
+void VER::check(Check &c, int count){
+  vector<int> xs, ys, tour;
+  string error;                                         // Reason instance cannot be read
+  c.status = 2;
+  if(!TSP::readCities(c.instance, xs, ys, &error)){     // If instance cannot be read
+    std::transform(error.begin(), error.end(), error.begin(), ::tolower);
+    c.message = "cannot read instance, " + error;
+    return;
+  }
+  long lines = countLines(c.instance);                  // Cities counted apart from the loader
+  if(lines != (long)xs.size()){                         // If loader lost or gained a city
+    c.message = "instance has " + std::to_string(lines) + " lines, " +
+                std::to_string(xs.size()) + " cities were read";
+    return;
+  }
+  if(!readTour(c.tour, c.claimed, tour)){               // If tour cannot be read
+    c.message = "cannot read tour";
+    return;
+  }
+  c.status = 1;
+  int size = xs.size();
+  if((int)tour.size() != size){                         // If tour has the wrong count of cities
+    c.message = "tour has " + std::to_string(tour.size()) + " cities, instance has " +
+                std::to_string(size);
+    return;
+  }
+
+  count = max(1, min(count, size / 10000 + 1));         // Keep at least 10,000 cities per thread
+  vector<std::atomic<char> > seen(size);                // Cities seen so far
+  vector<long long> costs(count, 0);                    // Cost of each part
+  vector<int> bad(count, -1);                           // First bad place of each part
+  auto part = [&](int k){                               // Check one part of the tour
+    int first = (long long)size*k/count, last = (long long)size*(k + 1)/count;
+    for(int i = first; i < last; i++){                    // For each place in part
+      int city = tour[i];
+      if(city < 0 || city >= size || seen[city].exchange(1)){   // If city is unknown or seen twice
+        bad[k] = i;
+        return;
+      }
+      int next = tour[(i + 1) % size];
+      if(next >= 0 && next < size){
+        costs[k] += TSP::getDistance(xs[city], ys[city], xs[next], ys[next]);
+      }
+    }
+  };
+  vector<std::thread> pool;
+  for(int k = 1; k < count; k++){                       // For each part but the first
+    pool.push_back(std::thread(part, k));                 // Check it on its own thread
+  }
+  part(0);                                              // Check first part on this thread
+  for(unsigned k = 0; k < pool.size(); k++){
+    pool[k].join();
+  }
+
+  c.cost = 0;
+  for(int k = 0; k < count; k++){                       // For each part
+    if(bad[k] >= 0){                                      // If part holds a bad city
+      int city = tour[bad[k]];
+      c.message = (city < 0 || city >= size ? "unknown city " : "city visited twice: ") +
+                  std::to_string(city);
+      return;
+    }
+    c.cost += costs[k];
+  }
+  if(c.cost != c.claimed){                              // If cost does not match file
+    c.message = "cost is " + std::to_string(c.cost) + ", file says " + std::to_string(c.claimed);
+    return;
+  }
+  c.status = 0;                                         // Tour passed
+}
+
+/********************************************************************************
+ * run() checks every pair and prints one line per pair in order. A single
+ * pair gets every thread; many pairs are shared out one per thread. Returns
+ * the worst status, for use as the exit code.
+********************************************************************************/
+int VER::run(vector<Check> &checks){
+  if(checks.size() == 1){                               // If there is one pair
+    check(checks[0], threads);                            // Check it with every thread
+  }
+  else{                                                 // Else
+    std::atomic<int> next(0);                             // Next pair to check
+    vector<std::thread> pool;
+    for(int t = 0; t < threads; t++){                     // For each thread
+      pool.push_back(std::thread([&](){
+        int i;
+        while((i = next++) < (int)checks.size()){
+          check(checks[i], 1);                              // Check pair
+        }
+      }));
+    }
+    for(int t = 0; t < threads; t++){
+      pool[t].join();
+    }
+  }
+
+  int worst = 0;
+  for(unsigned i = 0; i < checks.size(); i++){          // For each pair
+    Check &c = checks[i];
+    if(c.status == 0){
+      cout << "PASS " << c.instance << " " << c.tour << " " << c.cost << "\n";
+    }
+    else{
+      cout << "FAIL " << c.instance << " " << c.tour << ": " << c.message << "\n";
+    }
+    worst = max(worst, c.status);
+  }
+  cout.flush();
+  return worst;
+}
+
+/********************************************************************************
+ * Usage: ./tsp-verify [-j threads] [instance tour] ... [-b list]
+ *   -j  count of threads (default one per core)
+ *   -b  file of pairs, one "instance tour" per line
+ * Exit code: 0 every tour passed, 1 a tour is wrong, 2 a file could not be
+ * read or the arguments are wrong.
+********************************************************************************/
+int main(int argc, char *argv[]){
+  VER obj;                                            // Verifier object
+  vector<Check> checks;                               // Pairs to check
+  vector<string> names;                               // Instance and tour names in turn
+
+  for(int i = 1; i < argc; i++){                      // For each argument
+    string arg = argv[i];
+    if(arg == "-j" && i+1 < argc){                      // If count of threads is given
+      obj.setThreads(atoi(argv[++i]));
+    }
+    else if(arg == "-b" && i+1 < argc){                 // If a list of pairs is given
+      ifstream list(argv[++i]);
+      if(!list){
+        cout << "ERROR: FILE NOT FOUND" << endl;
+        return 2;
+      }
+      string instance, tour;
+      while(list >> instance >> tour){                    // For each pair in list
+        names.push_back(instance);
+        names.push_back(tour);
+      }
+    }
+    else{                                               // Else, argument is a file name
+      names.push_back(arg);
+    }
+  }
+  if(names.empty() || names.size() % 2){              // If files do not come in pairs
+    cout << "Usage: ./tsp-verify [-j threads] [instance tour] ... [-b list]" << endl;
+    return 2;
+  }
+  for(unsigned i = 0; i < names.size(); i += 2){      // For each pair
+    Check c = {names[i], names[i+1], 2, 0, 0, ""};
+    checks.push_back(c);
+  }
+  return obj.run(checks);                             // Check pairs
+}
@@ -0,0 +1,47 @@
+/********************************************************************************
+ * Project Group 7: Riley Kraft, Trevor Rollins, Andrew Tjossem
+ * Date: 06/08/2018
+ * Description: The VER class checks tour files written by the solver. A tour
+ *              passes if it visits every city of its instance exactly once and
+ *              its first line matches the tour's cost. Cities are read by the
+ *              solver's loader and distances are computed by the solver's
+ *              distance function, so the verifier agrees with the solver. The
+ *              instance's non-blank lines are also counted on their own, so a
+ *              city the loader loses fails the check instead of passing with a
+ *              tour that lost it too.
+ *              One pair is checked by several threads over parts of the tour;
+ *              many pairs are checked one pair per thread.
+ * Sources: see main.cpp header for program sources
+********************************************************************************/
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+struct Check{
+	string instance;         // Instance file name
+	string tour;             // Tour file name
+	int status;              // 0 passed, 1 tour is wrong, 2 file could not be read
+	long long cost;          // Cost of tour
+	long long claimed;       // Cost written in tour file
+	string message;          // Reason for failure
+};
+
+class VER{
+  public:
+	int threads;             // Count of threads
+
+  public:
+	VER();                                     // Constructor
+
+	void setThreads(int);                      // Set count of threads
+	int run(vector<Check>&);                   // Check every pair, return exit code
+	void check(Check&, int);                   // Check one pair with a count of threads
+	static bool readTour(string, long long&, vector<int>&);   // Read cost and cities of tour file
+	static long countLines(string);            // Count non-blank lines of a file
+};
+#endif